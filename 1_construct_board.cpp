@@ -37,6 +37,22 @@ Board make_starting_position() {
     board.black_can_castle_queenside = true;
 
     board.zobrist_hash = compute_zobrist(board); //compute hasing for starting position
+    board.material_key = compute_material_key(board);
     
     return board;
 }
+
+// Counts every piece on the board into a material signature.
+// make_move keeps it up to date afterwards.
+std::uint64_t compute_material_key(const Board& board) {
+    std::uint64_t key = 0;
+    for (int row = 0; row < BOARD_SIZE; ++row) {
+        for (int col = 0; col < BOARD_SIZE; ++col) {
+            const Piece& p = board.squares[row][col];
+            if (p.type != PieceType::None) {
+                key += material_key_unit(p.color, p.type);
+            }
+        }
+    }
+    return key;
+}
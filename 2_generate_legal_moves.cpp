@@ -140,6 +140,40 @@ void generate_queen_moves(const Board& board, int row, int col, std::vector<move
     generate_sliding_moves(board, row, col, directions, 8, moves);
 }
 
+// True if COLOR may castle on that side right now: rights kept, king and rook
+// on their squares, nothing in between, and the king neither in check nor
+// passing through or landing on an attacked square
+bool can_castle(const Board& board, Color color, bool kingside)
+{
+    int back_rank = (color == Color::White) ? 0 : 7;
+    bool has_right = (color == Color::White)
+        ? (kingside ? board.white_can_castle_kingside : board.white_can_castle_queenside)
+        : (kingside ? board.black_can_castle_kingside : board.black_can_castle_queenside);
+    if (!has_right) return false;
+
+    const Piece& king = board.squares[back_rank][4];
+    if (king.type != PieceType::King || king.color != color) return false;
+
+    // Rook must be on the h-file (kingside) or a-file (queenside)
+    const Piece& rook = board.squares[back_rank][kingside ? 7 : 0];
+    if (rook.type != PieceType::Rook || rook.color != color) return false;
+
+    // Squares between king and rook must be empty: f, g or d, c, b
+    int first_col = kingside ? 5 : 1;
+    int last_col = kingside ? 6 : 3;
+    for (int col = first_col; col <= last_col; ++col) {
+        if (board.squares[back_rank][col].type != PieceType::None) return false;
+    }
+
+    // Can't castle out of check, or pass through or land on attacked squares
+    Color enemy = (color == Color::White) ? Color::Black : Color::White;
+    int step = kingside ? 1 : -1;
+    for (int col = 4; col != 4 + 3 * step; col += step) {
+        if (is_attacked(board, back_rank, col, enemy)) return false;
+    }
+    return true;
+}
+
 void generate_castling_moves(Board& board, int row, int col, std::vector<move>& moves)
 {
     const Piece& king = board.squares[row][col];
@@ -151,85 +185,194 @@ void generate_castling_moves(Board& board, int row, int col, std::vector<move>&
     // King must be on starting square e-file
     if (row != back_rank || col != 4) return;
 
-    Color enemy = (color == Color::White) ? Color::Black : Color::White;
-
-    // Can't castle out of check
-    if (is_attacked(board, back_rank, 4, enemy)) return;
+    if (can_castle(board, color, true)) {
+        moves.emplace_back(back_rank, 4, back_rank, 6, NONE);
+    }
+    if (can_castle(board, color, false)) {
+        moves.emplace_back(back_rank, 4, back_rank, 2, NONE);
+    }
+}
 
-    // Kingside
-    bool can_kingside = (color == Color::White)
-        ? board.white_can_castle_kingside
-        : board.black_can_castle_kingside;
+void generate_king_moves(Board& board, int row, int col, std::vector<move>& moves) {
+    static const int offsets[8][2] = {
+        {1, 0}, {-1, 0}, {0, 1}, {0, -1},
+        {1, 1}, {1, -1}, {-1, 1}, {-1, -1}
+    };
 
-    if (can_kingside) {
-        // Squares between king and rook must be empty: f, g
-        if (board.squares[back_rank][5].type == PieceType::None &&
-            board.squares[back_rank][6].type == PieceType::None) {
+    for (auto& offset : offsets) {
+        add_move_if_valid(board, row, col, row + offset[0], col + offset[1], moves);
+    }
 
-            // Rook must be on h-file
-            const Piece& rook = board.squares[back_rank][7];
-            if (rook.type == PieceType::Rook && rook.color == color) {
+    generate_castling_moves(board, row, col, moves);
+}
 
-                // Can't pass through or land on attacked squares
-                if (!is_attacked(board, back_rank, 5, enemy) &&
-                    !is_attacked(board, back_rank, 6, enemy)) {
+int sign(int x) {
+    return (x > 0) - (x < 0);
+}
 
-                    moves.emplace_back(back_rank, 4, back_rank, 6, NONE);
-                }
-            }
-        }
+// True if every square strictly between FROM and TO (on one line) is empty
+bool path_is_clear(const Board& board, int from_row, int from_col, int to_row, int to_col) {
+    int d_row = sign(to_row - from_row);
+    int d_col = sign(to_col - from_col);
+    for (int row = from_row + d_row, col = from_col + d_col;
+         row != to_row || col != to_col;
+         row += d_row, col += d_col) {
+        if (board.squares[row][col].type != PieceType::None) return false;
     }
+    return true;
+}
 
-    // Queenside
-    bool can_queenside = (color == Color::White)
-        ? board.white_can_castle_queenside
-        : board.black_can_castle_queenside;
-
-    if (can_queenside) {
-        // Squares between king and rook must be empty: d, c, b
-        if (board.squares[back_rank][3].type == PieceType::None &&
-            board.squares[back_rank][2].type == PieceType::None &&
-            board.squares[back_rank][1].type == PieceType::None) {
+bool pawn_move_is_pseudo_legal(const Board& board, const move& m) {
+    const Piece& piece = board.squares[m.from_row][m.from_col];
+    const Piece& target = board.squares[m.to_row][m.to_col];
+    int direction = (piece.color == Color::White) ? 1 : -1;
+    int start_row = (piece.color == Color::White) ? 1 : 6;
+    int d_row = m.to_row - m.from_row;
+    int d_col = m.to_col - m.from_col;
+
+    // Reaching the last rank must promote, and only that may
+    bool promote_rank = m.to_row == (piece.color == Color::White ? BOARD_SIZE - 1 : 0);
+    if ((m.promotion != NONE) != promote_rank) return false;
+
+    // Pushes: one square, or two from the start row, onto empty squares
+    if (d_col == 0) {
+        if (target.type != PieceType::None) return false;
+        if (d_row == direction) return true;
+        return d_row == 2 * direction && m.from_row == start_row &&
+               board.squares[m.from_row + direction][m.from_col].type == PieceType::None;
+    }
 
-            // Rook must be on a-file
-            const Piece& rook = board.squares[back_rank][0];
-            if (rook.type == PieceType::Rook && rook.color == color) {
+    // Captures: diagonally forward onto an enemy piece or the en passant square
+    if (d_row != direction || (d_col != 1 && d_col != -1)) return false;
+    if (target.type != PieceType::None) return true;  // own pieces are excluded by the caller
 
-                // Can't pass through or land on attacked squares
-                if (!is_attacked(board, back_rank, 3, enemy) &&
-                    !is_attacked(board, back_rank, 2, enemy)) {
+    // The captured pawn sits on the same row as the capturing pawn
+    const Piece& enemy_pawn = board.squares[m.from_row][m.to_col];
+    return m.to_row == board.en_passant_row && m.to_col == board.en_passant_col &&
+           enemy_pawn.type == PieceType::Pawn && enemy_pawn.color != piece.color;
+}
 
-                    moves.emplace_back(back_rank, 4, back_rank, 2, NONE);
-                }
+bool find_king(const Board& board, Color color, int& king_row, int& king_col) {
+    for (int row = 0; row < BOARD_SIZE; ++row) {
+        for (int col = 0; col < BOARD_SIZE; ++col) {
+            const Piece& p = board.squares[row][col];
+            if (p.type == PieceType::King && p.color == color) {
+                king_row = row;
+                king_col = col;
+                return true;
             }
         }
     }
+    return false;
 }
 
+// True if the piece on FROM is pinned to its king and M leaves the pin line
+bool breaks_pin(const Board& board, const move& m, int king_row, int king_col) {
+    int d_row = m.from_row - king_row;
+    int d_col = m.from_col - king_col;
+    bool straight = (d_row == 0 || d_col == 0);
+    bool diagonal = (d_row == d_col || d_row == -d_col);
+    if (!straight && !diagonal) return false;  // not on a line with the king
+
+    int step_row = sign(d_row);
+    int step_col = sign(d_col);
+    if (!path_is_clear(board, king_row, king_col, m.from_row, m.from_col)) return false;
+
+    // Staying on the line from the king keeps the king covered
+    int to_row = m.to_row - king_row;
+    int to_col = m.to_col - king_col;
+    if (sign(to_row) == step_row && sign(to_col) == step_col &&
+        to_row * step_col == to_col * step_row) {
+        return false;
+    }
 
+    // First piece behind FROM, seen from the king: a slider of the right kind pins
+    const Color us = board.squares[m.from_row][m.from_col].color;
+    for (int row = m.from_row + step_row, col = m.from_col + step_col;
+         is_valid_square(row, col);
+         row += step_row, col += step_col) {
+        const Piece& p = board.squares[row][col];
+        if (p.type == PieceType::None) continue;
+        if (p.color == us) return false;
+        return p.type == PieceType::Queen ||
+               p.type == (straight ? PieceType::Rook : PieceType::Bishop);
+    }
+    return false;
+}
 
-void generate_king_moves(Board& board, int row, int col, std::vector<move>& moves) {
-    static const int offsets[8][2] = {
-        {1, 0}, {-1, 0}, {0, 1}, {0, -1},
-        {1, 1}, {1, -1}, {-1, 1}, {-1, -1}
-    };
+} 
 
-    for (auto& offset : offsets) {
-        add_move_if_valid(board, row, col, row + offset[0], col + offset[1], moves);
+bool is_pseudo_legal(const Board& board, const move& m) {
+    if (!is_valid_square(m.from_row, m.from_col) || !is_valid_square(m.to_row, m.to_col)) {
+        return false;
+    }
+    if (m.from_row == m.to_row && m.from_col == m.to_col) return false;
+
+    const Piece& piece = board.squares[m.from_row][m.from_col];
+    const Piece& target = board.squares[m.to_row][m.to_col];
+    if (piece.type == PieceType::None || piece.color != board.side_to_move) return false;
+    if (target.type != PieceType::None && target.color == piece.color) return false;
+    if (piece.type != PieceType::Pawn && m.promotion != NONE) return false;
+
+    int d_row = m.to_row - m.from_row;
+    int d_col = m.to_col - m.from_col;
+    int abs_row = d_row < 0 ? -d_row : d_row;
+    int abs_col = d_col < 0 ? -d_col : d_col;
+
+    switch (piece.type) {
+        case PieceType::Pawn:
+            return pawn_move_is_pseudo_legal(board, m);
+        case PieceType::Knight:
+            return (abs_row == 1 && abs_col == 2) || (abs_row == 2 && abs_col == 1);
+        case PieceType::Bishop:
+            return abs_row == abs_col &&
+                   path_is_clear(board, m.from_row, m.from_col, m.to_row, m.to_col);
+        case PieceType::Rook:
+            return (d_row == 0 || d_col == 0) &&
+                   path_is_clear(board, m.from_row, m.from_col, m.to_row, m.to_col);
+        case PieceType::Queen:
+            return (d_row == 0 || d_col == 0 || abs_row == abs_col) &&
+                   path_is_clear(board, m.from_row, m.from_col, m.to_row, m.to_col);
+        case PieceType::King:
+            if (abs_row <= 1 && abs_col <= 1) return true;
+            // Castling: e-file to g- or c-file on the back rank
+            return d_row == 0 && abs_col == 2 && m.from_col == 4 &&
+                   m.from_row == (piece.color == Color::White ? 0 : 7) &&
+                   can_castle(board, piece.color, d_col > 0);
+        case PieceType::None:
+        default:
+            return false;
     }
-
-    generate_castling_moves(board, row, col, moves);
 }
 
-} 
+bool is_legal(const Board& board, const move& m) {
+    if (!is_pseudo_legal(board, m)) return false;
+
+    const Piece& piece = board.squares[m.from_row][m.from_col];
+    const Color us = piece.color;
+    const bool en_passant = piece.type == PieceType::Pawn && m.from_col != m.to_col &&
+                            board.squares[m.to_row][m.to_col].type == PieceType::None;
+
+    // King moves, en passant (two pieces leave the row) and check evasions:
+    // play the move on a copy and look
+    int king_row = -1, king_col = -1;
+    if (piece.type == PieceType::King || en_passant ||
+        !find_king(board, us, king_row, king_col) || is_in_check(board, us)) {
+        Board after = board;
+        make_move(after, m);
+        return !is_in_check(after, us);
+    }
 
-std::vector<move> generate_legal_moves(const Board& board_in) {
+    // Otherwise only a pin can expose the king
+    return !breaks_pin(board, m, king_row, king_col);
+}
+
+void generate_legal_moves(const Board& board_in, std::vector<move>& moves) {
     Board board = board_in;
 
-    std::vector<move> moves;
-    moves.reserve(50);
-    std::vector<move> pseudo_legal_moves;
-    pseudo_legal_moves.reserve(50);
+    // Generate pseudo-legal moves straight into the caller's buffer so its
+    // capacity is reused between calls (no allocation in the search)
+    moves.clear();
 
     for (int row = 0; row < BOARD_SIZE; ++row) {
         for (int col = 0; col < BOARD_SIZE; ++col) {
@@ -237,22 +380,22 @@ std::vector<move> generate_legal_moves(const Board& board_in) {
             if (piece.color == board.side_to_move) {
                 switch (piece.type) {
                     case PieceType::Pawn:
-                        generate_pawn_moves(board, row, col, pseudo_legal_moves);
+                        generate_pawn_moves(board, row, col, moves);
                         break;
                     case PieceType::Knight:
-                        generate_knight_moves(board, row, col, pseudo_legal_moves);
+                        generate_knight_moves(board, row, col, moves);
                         break;
                     case PieceType::Bishop:
-                        generate_bishop_moves(board, row, col, pseudo_legal_moves);
+                        generate_bishop_moves(board, row, col, moves);
                         break;
                     case PieceType::Rook:
-                        generate_rook_moves(board, row, col, pseudo_legal_moves);
+                        generate_rook_moves(board, row, col, moves);
                         break;
                     case PieceType::Queen:
-                        generate_queen_moves(board, row, col, pseudo_legal_moves);
+                        generate_queen_moves(board, row, col, moves);
                         break;
                     case PieceType::King:
-                        generate_king_moves(board, row, col, pseudo_legal_moves);
+                        generate_king_moves(board, row, col, moves);
                         break;
                     case PieceType::None:
                     default:
@@ -262,18 +405,27 @@ std::vector<move> generate_legal_moves(const Board& board_in) {
         }
     }
 
-    // Filter moves that leave the king in check
-    for (const auto& m : pseudo_legal_moves) {
+    // Filter moves that leave the king in check, compacting the legal ones
+    // to the front of the buffer
+    size_t legal_count = 0;
+    Color us = board.side_to_move;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const move m = moves[i];
         Undo u;
-        Color us = board.side_to_move;
         make_move(board, m, u);
 
         if (!is_in_check(board, us)) {
-            moves.push_back(m);
+            moves[legal_count++] = m;
         }
 
         unmake_move(board, m , u);
     }
+    moves.resize(legal_count);
+}
 
+std::vector<move> generate_legal_moves(const Board& board) {
+    std::vector<move> moves;
+    moves.reserve(50);
+    generate_legal_moves(board, moves);
     return moves;
 }
@@ -896,18 +896,19 @@ int evaluate_board(const Board& board) {
 // Checkmate score constant - used by search to detect mate
 constexpr int CHECKMATE_SCORE = 100000;
 
-int evaluate_terminal(const Board& board, int depth) {
+int evaluate_terminal(const Board& board, int ply) {
     // No legal moves + in check => checkmate
-    // Depth-adjusted: prefer faster mates (higher depth = found earlier = better)
+    // Ply-adjusted: a mate nearer the root scores higher for the winner, and
+    // CHECKMATE_SCORE - |score| is the distance to mate in plies
     if (is_in_check(board, board.side_to_move)) {
-        return -(CHECKMATE_SCORE - depth);  // Faster mate = higher score magnitude
+        return -(CHECKMATE_SCORE - ply);  // Faster mate = higher score magnitude
     }
 
     // No legal moves + not in check => stalemate
     return 0;
 }
 
-// Overload for backward compatibility (used by quiescence search at depth 0)
+// Overload for backward compatibility (a mate at the root)
 int evaluate_terminal(const Board& board) {
     return evaluate_terminal(board, 0);
 }
@@ -8,8 +8,11 @@
 #include <cmath>
 #include <cstdint>
 #include <chrono>        // For time management
-#include <unordered_map> // For O(1) repetition detection
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include "attacks.h"
+#include "time_manager.h"
 
 // ============================================================================
 // TRANSPOSITION TABLE - Caches evaluated positions for faster search
@@ -25,6 +28,20 @@ void clear_transposition_table() {
     g_tt.clear();
 }
 
+// Resize the transposition table (drops its contents)
+void resize_transposition_table(std::size_t mb) {
+    g_tt.resize_mb(mb);
+}
+
+// Persist the transposition table between processes (per-move mode)
+bool save_transposition_table(const std::string& path) {
+    return g_tt.save(path);
+}
+
+bool load_transposition_table(const std::string& path) {
+    return g_tt.load(path);
+}
+
 // implemented negamax with alpha-beta pruning
 // generate legal moves, simulate the move, evaluate the board, choose best score
 
@@ -35,25 +52,169 @@ void clear_transposition_table() {
 // - Start with depth 1, increase depth after each completed search
 // - Check time periodically during search and abort if time runs out
 // - Always return the best move found so far
+//
+// Reading the clock at every node would cost a steady_clock::now() call per
+// node, millions of times a second. Inside the tree we count nodes instead
+// and only read the clock every g_poll_interval nodes. Each poll re-tunes the
+// interval from the speed measured since the previous poll, so polls land
+// about every TIME_POLL_PERIOD_MS whatever the NPS. That bounds how late an
+// abort can be noticed.
+//
+// The same polls serve the other ways a search can end early: a stop request
+// from another thread (UCI "stop") and a node budget (UCI "go nodes"). The
+// countdown is shortened so a node budget is hit exactly.
+//
+// The clock, limits and counters are per thread, so searches running side by
+// side (server mode) each keep their own budget. The stop and ponder flags
+// are shared: they are set from outside any search.
 // ============================================================================
 
-static std::chrono::steady_clock::time_point g_search_start;
-static int g_time_limit_ms = 0;
-static bool g_search_aborted = false;
+static thread_local std::chrono::steady_clock::time_point g_search_start;
+static thread_local int g_time_limit_ms = 0;
+static thread_local bool g_search_aborted = false;
+
+constexpr int TIME_POLL_PERIOD_MS = 1;           // Target time between two clock polls
+constexpr std::int64_t MIN_POLL_INTERVAL = 64;   // Nodes between polls, whatever the speed
+constexpr std::int64_t MAX_POLL_INTERVAL = 1 << 16;
+constexpr std::int64_t INITIAL_POLL_INTERVAL = 1024;  // Until the first speed measurement
+
+static thread_local std::uint64_t g_time_polls = 0;           // clock reads made by the node countdown
+static thread_local std::int64_t g_poll_interval = INITIAL_POLL_INTERVAL;
+static thread_local std::int64_t g_nodes_until_poll = INITIAL_POLL_INTERVAL;
+static thread_local std::chrono::steady_clock::time_point g_last_poll;
+static thread_local long long g_abort_overrun_ms = 0;         // how far past the limit the abort was noticed
+
+static std::atomic<bool> g_stop_requested{false};  // set by request_search_stop(), any thread
+static std::atomic<bool> g_pondering{false};       // time limits suspended until a ponder hit
+static thread_local std::uint64_t g_node_limit = 0;           // 0 = no node budget
+static thread_local std::uint64_t g_polled_nodes = 0;         // nodes counted down by completed countdowns
+static thread_local std::int64_t g_countdown_nodes = INITIAL_POLL_INTERVAL;  // length of the current countdown
+
+// Ask the running (or next) search to stop as soon as possible.
+// Stays set until reset_search_stop().
+void request_search_stop() {
+    g_stop_requested.store(true, std::memory_order_relaxed);
+}
+
+// Clear a stop request - call before starting a search that may be stopped
+void reset_search_stop() {
+    g_stop_requested.store(false, std::memory_order_relaxed);
+}
+
+static bool search_stop_requested() {
+    return g_stop_requested.load(std::memory_order_relaxed);
+}
+
+// PONDERING: while set, the search ignores its time limits (stop requests and
+// node budgets still apply). Clearing it on a ponder hit turns the running
+// search into a normal timed one. The clock started with the search, so the
+// time already spent pondering counts - after a long ponder we move quickly.
+void set_search_pondering(bool pondering) {
+    g_pondering.store(pondering, std::memory_order_relaxed);
+}
+
+static bool search_pondering() {
+    return g_pondering.load(std::memory_order_relaxed);
+}
 
 // Initialize time limit for search
 void set_time_limit(int ms) {
     g_search_start = std::chrono::steady_clock::now();
     g_time_limit_ms = ms;
     g_search_aborted = false;
+
+    g_time_polls = 0;
+    g_poll_interval = INITIAL_POLL_INTERVAL;
+    g_nodes_until_poll = INITIAL_POLL_INTERVAL;
+    g_countdown_nodes = INITIAL_POLL_INTERVAL;
+    g_polled_nodes = 0;
+    g_node_limit = 0;
+    g_last_poll = g_search_start;
+    g_abort_overrun_ms = 0;
+}
+
+// Node budget for the search that set_time_limit just started (0 = none)
+static void set_node_limit(std::uint64_t nodes) {
+    g_node_limit = nodes;
+    if (nodes > 0 && static_cast<std::uint64_t>(g_nodes_until_poll) > nodes) {
+        g_nodes_until_poll = g_countdown_nodes = static_cast<std::int64_t>(nodes);
+    }
+}
+
+// Milliseconds since set_time_limit
+static long long elapsed_ms(std::chrono::steady_clock::time_point now) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(now - g_search_start).count();
+}
+
+// Remember the overrun the first time the limit is seen to be exceeded
+static void note_time_up(long long elapsed) {
+    if (!g_search_aborted) {
+        g_abort_overrun_ms = elapsed - g_time_limit_ms;
+    }
 }
 
-// Check if time limit has been exceeded
+// Check if time limit has been exceeded (reads the clock - use between
+// iterations and at the root, not at every node)
 bool time_is_up() {
-    if (g_time_limit_ms <= 0) return false;  // No time limit set
+    if (g_time_limit_ms <= 0 || search_pondering()) return false;  // No time limit (yet)
+    long long elapsed = elapsed_ms(std::chrono::steady_clock::now());
+    if (elapsed < g_time_limit_ms) return false;
+    note_time_up(elapsed);
+    return true;
+}
+
+// Per-node limit check: looks at the clock, the stop flag and the node
+// budget only when the node countdown runs out. Once the search is aborted
+// it stays aborted.
+static bool node_time_is_up() {
+    if (g_search_aborted) return true;
+    if (--g_nodes_until_poll > 0) return false;
+
+    g_polled_nodes += g_countdown_nodes;
+    if (search_stop_requested()) return true;
+    if (g_node_limit > 0 && g_polled_nodes >= g_node_limit) return true;
+
+    ++g_time_polls;
     auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - g_search_start).count();
-    return elapsed >= g_time_limit_ms;
+    if (g_time_limit_ms > 0 && !search_pondering()) {
+        long long elapsed = elapsed_ms(now);
+        if (elapsed >= g_time_limit_ms) {
+            note_time_up(elapsed);
+            return true;
+        }
+    }
+
+    // Re-tune: nodes per TIME_POLL_PERIOD_MS at the speed since the last poll
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(now - g_last_poll).count();
+    if (us > 0) {
+        std::int64_t per_period = g_countdown_nodes * 1000 * TIME_POLL_PERIOD_MS / us;
+        g_poll_interval = std::clamp(per_period, MIN_POLL_INTERVAL, MAX_POLL_INTERVAL);
+    }
+    g_last_poll = now;
+    g_countdown_nodes = g_poll_interval;
+    if (g_node_limit > 0) {
+        g_countdown_nodes = std::min<std::int64_t>(g_countdown_nodes,
+                                                   static_cast<std::int64_t>(g_node_limit - g_polled_nodes));
+    }
+    g_nodes_until_poll = g_countdown_nodes;
+    return false;
+}
+
+// Exact check for the root and between iterations: time, stop request and
+// node budget
+static bool search_limit_reached() {
+    if (search_stop_requested()) return true;
+    if (g_node_limit > 0 && g_polled_nodes + (g_countdown_nodes - g_nodes_until_poll) >= g_node_limit) {
+        return true;
+    }
+    return time_is_up();
+}
+
+// Listener for completed iterations (anytime output, deadline watchdog)
+static IterationCallback g_iteration_callback = nullptr;
+
+void set_iteration_callback(IterationCallback callback) {
+    g_iteration_callback = callback;
 }
 
 // Check if search was aborted due to timeout
@@ -62,57 +223,57 @@ bool search_was_aborted() {
 } 
 
 // ============================================================================
-// REPETITION DETECTION - Prevents threefold repetition draws (O(1) lookup)
+// REPETITION DETECTION - Prevents threefold repetition draws
 // ============================================================================
-// We store Zobrist hashes of all positions that occurred in the game.
-// If a position appears 3 times, it's a draw. We also treat 2 repetitions
-// as a "likely draw" in the search to discourage repeating positions.
+// We keep a stack of Zobrist hashes: every position of the game so far,
+// followed by the positions on the current search path (pushed/popped as
+// the search makes and unmakes moves). If a position appears 3 times, it's
+// a draw. We also treat 2 repetitions as a "likely draw" in the search to
+// discourage repeating positions.
 //
-// OPTIMIZATION: Uses unordered_map for O(1) count lookup instead of O(n) scan.
-// The vector maintains order for push/pop operations during search.
+// A position can only repeat within the reversible part of the game (no
+// capture or pawn move since), which the halfmove clock tells us, and only
+// with the same side to move. So we scan backwards from the current position
+// in steps of two, at most halfmove_clock plies. That's usually just a
+// handful of entries - cheaper than hashing into a map at every node.
 // ============================================================================
 
-// Global history of positions (hashes) from the game - maintains order for undo
-static std::vector<std::uint64_t> g_position_history;
-// Hash count map for O(1) repetition counting
-static std::unordered_map<std::uint64_t, int> g_position_count;
-
-// Count how many times a hash appears in history - O(1) lookup
-static int count_repetitions(std::uint64_t hash) {
-    auto it = g_position_count.find(hash);
-    if (it != g_position_count.end()) {
-        return it->second;
+// Hash stack: game history followed by the current search path
+static thread_local std::vector<std::uint64_t> g_position_history;
+
+// Count how many times 'hash' (the position after the latest move, not yet
+// pushed) appears among the positions reachable by reversible moves
+static int count_repetitions(std::uint64_t hash, int halfmove_clock) {
+    const int size = static_cast<int>(g_position_history.size());
+    const int limit = std::min(halfmove_clock, size);
+    int count = 0;
+    // The entry k plies back is g_position_history[size - k] (k = 1 is the parent)
+    for (int k = 2; k <= limit; k += 2) {
+        if (g_position_history[size - k] == hash) {
+            ++count;
+        }
     }
-    return 0;
+    return count;
 }
 
 // Add a position to history (called when parsing game history and during search)
 void add_position_to_history(std::uint64_t hash) {
     g_position_history.push_back(hash);
-    g_position_count[hash]++;
 }
 
 // Remove the last position from history (for undoing moves in search)
 void remove_last_position_from_history() {
     if (!g_position_history.empty()) {
-        std::uint64_t hash = g_position_history.back();
         g_position_history.pop_back();
-        
-        // Decrement count in map
-        auto it = g_position_count.find(hash);
-        if (it != g_position_count.end()) {
-            it->second--;
-            if (it->second <= 0) {
-                g_position_count.erase(it);  // Clean up zero-count entries
-            }
-        }
     }
 }
 
 // Clear all position history (called at start of new game)
 void clear_position_history() {
     g_position_history.clear();
-    g_position_count.clear();
+    // Room for a long game plus the deepest search path, so pushes in the
+    // search never reallocate
+    g_position_history.reserve(1024);
 }
 
 // Get current history size (for debugging)
@@ -120,6 +281,18 @@ size_t get_position_history_size() {
     return g_position_history.size();
 }
 
+// The history belongs to the calling thread. A search that runs on another
+// thread than the one that read the game (UCI worker, server pool) is handed
+// a copy and installs it before searching.
+std::vector<std::uint64_t> get_position_history() {
+    return g_position_history;
+}
+
+void set_position_history(const std::vector<std::uint64_t>& hashes) {
+    clear_position_history();
+    g_position_history.insert(g_position_history.end(), hashes.begin(), hashes.end());
+}
+
 // namespace for local functions
 // prevents other files from calling negamax(), select_move(), find_best_move() directly
 // can only call find_best_move()
@@ -127,7 +300,25 @@ namespace {
 constexpr int NEG_INF = -1000000; // negative infinity
 constexpr int POS_INF = 1000000; // positive infinity
 constexpr int MAX_QS_DEPTH = 10;  // Limit quiescence to 10 plies of captures
-constexpr int DRAW_SCORE = 0;    // Score for draw by repetition
+constexpr int DRAW_SCORE = 0;    // Score for draw by repetition, the 50-move rule or insufficient material
+constexpr int FIFTY_MOVE_PLIES = 100;  // Halfmove clock value that ends the game in a draw
+// Mate detection threshold - scores near CHECKMATE_SCORE indicate forced mate
+constexpr int MATE_THRESHOLD = 90000;    // CHECKMATE_SCORE is 100000
+
+// Mate scores count plies from the root (CHECKMATE_SCORE - ply of the mate).
+// The TT stores them counted from the node instead, so an entry still gives
+// the right distance when the position comes up again at another ply
+int score_to_tt(int score, int ply) {
+    if (score >= MATE_THRESHOLD) return score + ply;
+    if (score <= -MATE_THRESHOLD) return score - ply;
+    return score;
+}
+
+int score_from_tt(int score, int ply) {
+    if (score >= MATE_THRESHOLD) return score - ply;
+    if (score <= -MATE_THRESHOLD) return score + ply;
+    return score;
+}
 
 // ============================================================================
 // CONTEMPT FACTOR - Makes the engine avoid draws
@@ -138,6 +329,13 @@ constexpr int DRAW_SCORE = 0;    // Score for draw by repetition
 // ============================================================================
 constexpr int CONTEMPT = 25;     // Treat draws as -25 centipawns (slight loss)
 
+// Value of a draw for the side to move at PLY. Contempt is the root side's:
+// a draw costs it CONTEMPT, so it is worth CONTEMPT to the opponent. Every
+// kind of draw (repetition, 50-move rule, dead position) scores this
+int draw_score(int ply) {
+    return ply % 2 == 0 ? DRAW_SCORE - CONTEMPT : DRAW_SCORE + CONTEMPT;
+}
+
 // ============================================================================
 // NULL MOVE PRUNING CONSTANTS
 // ============================================================================
@@ -146,54 +344,125 @@ constexpr int CONTEMPT = 25;     // Treat draws as -25 centipawns (slight loss)
 // ============================================================================
 constexpr int NULL_MOVE_REDUCTION = 3;  // Reduce depth by 3 for null move search
 constexpr int NULL_MOVE_MIN_DEPTH = 3;  // Only apply null move at depth >= 3
+// Verification search: a null move fail-high is re-checked with a normal
+// reduced search (null move disabled) when zugzwang is plausible - little
+// non-pawn material left - or when the cutoff would skip a deep subtree.
+constexpr int NULL_VERIFY_MATERIAL = 500;  // Verify if side has <= a rook's worth of pieces
+constexpr int NULL_VERIFY_DEPTH = 10;      // Always verify at depth >= 10
+
+// ============================================================================
+// SEARCH STACK - Per-ply data kept while walking down the tree
+// ============================================================================
+// ply = distance from the root. Everything a node needs to remember lives in
+// its entry instead of being recomputed or allocated:
+// - static eval, in-check flag and excluded move (singular extensions)
+// - the move currently being searched, so children can look up the
+//   countermove and continuation history for it
+// - killer moves for this ply
+// - move list / ordering score buffers, whose capacity is kept between
+//   nodes so the search doesn't allocate once it has warmed up
+// plus one Undo record per ply for make_move/unmake_move.
+//
+// Quiescence continues past MAX_PLY, so the stack has room for MAX_QS_DEPTH
+// extra plies. The stack is thread_local: every search thread owns one.
+// ============================================================================
+constexpr int MAX_PLY = 128;
+constexpr int STACK_SIZE = MAX_PLY + MAX_QS_DEPTH + 2;
+
+// A node at a given ply can need up to three live move lists at once:
+// its own negamax list, the list of a singular verification search of the
+// same position, and quiescence lists started from that verification search
+enum MoveListSlot {
+    MAIN_MOVES = 0,
+    SINGULAR_MOVES = 1,
+    QS_MOVES = 2,
+    MOVE_LIST_SLOTS = 3
+};
+
+struct SearchStackEntry {
+    int static_eval = 0;
+    bool in_check = false;
+    move current_move{};        // move being searched from this node
+    int moved_piece = -1;       // piece_index() of its mover, -1 for a null move
+    move excluded_move{};       // move skipped by a singular verification search
+    bool has_excluded = false;
+    move killers[2];            // 2 killer moves per ply
+
+    std::vector<move> moves[MOVE_LIST_SLOTS];
+    std::vector<int> scores;    // ordering scores, parallel to the list being sorted
+};
+
+struct SearchStack {
+    SearchStackEntry entries[STACK_SIZE];
+    Undo undo[STACK_SIZE];
+
+    SearchStack() {
+        for (SearchStackEntry& e : entries) {
+            for (std::vector<move>& list : e.moves) list.reserve(64);
+            e.scores.reserve(64);
+        }
+    }
+
+    SearchStackEntry& operator[](int ply) { return entries[ply]; }
+};
+static thread_local SearchStack g_search_stack;
+
+// Index of a piece in the history tables: 0-6 White, 7-13 Black (by PieceType)
+constexpr int PIECE_INDEX_COUNT = 14;
+int piece_index(const Piece& p) {
+    return (p.color == Color::White ? 0 : 7) + static_cast<int>(p.type);
+}
 
 // ============================================================================
-// KILLER MOVES - Quiet moves that caused cutoffs at each depth
+// KILLER MOVES - Quiet moves that caused cutoffs at each ply
 // ============================================================================
 // Killer move heuristic: Remember quiet (non-capture) moves that caused
 // beta cutoffs. These moves are likely good in sibling positions at the
-// same depth, so we try them early in move ordering.
+// same ply, so we try them early in move ordering.
 // 
-// We store 2 killers per depth (slots 0 and 1). When we find a new killer,
-// we shift the old killer[0] to killer[1] and store the new one in killer[0].
+// We store 2 killers per ply (slots 0 and 1) in the search stack. When we
+// find a new killer, we shift the old killer[0] to killer[1] and store the
+// new one in killer[0]. Killers are indexed by distance from the root rather
+// than remaining depth, so reductions and extensions don't mix up unrelated
+// positions.
 // ============================================================================
-constexpr int MAX_KILLER_DEPTH = 64;
-static move g_killers[MAX_KILLER_DEPTH][2];  // 2 killer moves per depth
 
-// Initialize killer move table (call at start of search)
+// Initialize killer moves (call at start of search)
 void clear_killers() {
-    for (int d = 0; d < MAX_KILLER_DEPTH; ++d) {
-        g_killers[d][0] = move(0, 0, 0, 0);
-        g_killers[d][1] = move(0, 0, 0, 0);
+    for (SearchStackEntry& e : g_search_stack.entries) {
+        e.killers[0] = move(0, 0, 0, 0);
+        e.killers[1] = move(0, 0, 0, 0);
     }
 }
 
-// Store a killer move at the given depth
-void store_killer(int depth, const move& m) {
-    if (depth < 0 || depth >= MAX_KILLER_DEPTH) return;
+// Store a killer move at the given ply
+void store_killer(int ply, const move& m) {
+    if (ply < 0 || ply >= STACK_SIZE) return;
+    move* killers = g_search_stack[ply].killers;
     
     // Don't store if it's already killer[0]
-    if (g_killers[depth][0].from_row == m.from_row &&
-        g_killers[depth][0].from_col == m.from_col &&
-        g_killers[depth][0].to_row == m.to_row &&
-        g_killers[depth][0].to_col == m.to_col) {
+    if (killers[0].from_row == m.from_row &&
+        killers[0].from_col == m.from_col &&
+        killers[0].to_row == m.to_row &&
+        killers[0].to_col == m.to_col) {
         return;
     }
     
     // Shift killer[0] to killer[1], store new killer in [0]
-    g_killers[depth][1] = g_killers[depth][0];
-    g_killers[depth][0] = m;
+    killers[1] = killers[0];
+    killers[0] = m;
 }
 
-// Check if a move is a killer at the given depth
-bool is_killer(int depth, const move& m) {
-    if (depth < 0 || depth >= MAX_KILLER_DEPTH) return false;
+// Check if a move is a killer at the given ply
+bool is_killer(int ply, const move& m) {
+    if (ply < 0 || ply >= STACK_SIZE) return false;
+    const move* killers = g_search_stack[ply].killers;
     
     for (int i = 0; i < 2; ++i) {
-        if (g_killers[depth][i].from_row == m.from_row &&
-            g_killers[depth][i].from_col == m.from_col &&
-            g_killers[depth][i].to_row == m.to_row &&
-            g_killers[depth][i].to_col == m.to_col) {
+        if (killers[i].from_row == m.from_row &&
+            killers[i].from_col == m.from_col &&
+            killers[i].to_row == m.to_row &&
+            killers[i].to_col == m.to_col) {
             return true;
         }
     }
@@ -201,72 +470,214 @@ bool is_killer(int depth, const move& m) {
 }
 
 // ============================================================================
-// HISTORY HEURISTIC - Track quiet moves that caused cutoffs historically
+// HISTORY HEURISTICS - Track which moves caused cutoffs historically
 // ============================================================================
-// The history heuristic keeps track of which quiet moves have been good in the
-// past. When a quiet move causes a beta cutoff, we increase its history score.
-// This helps order quiet moves better, putting historically good moves first.
+// When a move causes a beta cutoff it gets a bonus, and the moves of the same
+// kind that were tried before it (and failed) get a malus. Tables:
 //
-// Array: g_history[color][from_square][to_square]
-// - color: 0 = White, 1 = Black
-// - from_square: 0-63 (row * 8 + col)
-// - to_square: 0-63 (row * 8 + col)
+// - history[color][from][to]: butterfly history for quiet moves
+// - continuation[n][prev_piece][prev_to][piece][to]: quiet moves in reply
+//   to the move played 1 ply (n = 0) or 2 plies (n = 1) earlier
+// - capture[piece][to][captured_type]: captures
+// - countermoves[prev_piece][prev_to]: the quiet move that last refuted
+//   the opponent's previous move
+//
+// Updates use "gravity": entry += bonus - entry * |bonus| / HISTORY_MAX,
+// which keeps every entry within [-HISTORY_MAX, HISTORY_MAX] and lets new
+// information overwrite stale values. The tables persist between searches
+// and are halved (aged) at the start of each one.
+//
+// Each search thread has its own tables (server mode searches several games
+// at once). They are heap-allocated on first use: the continuation history
+// alone is 6 MB, too big for thread-local storage.
 // ============================================================================
-static int g_history[2][64][64];  // History scores for quiet moves
-
-// Clear history table (call at start of search)
-void clear_history() {
-    for (int c = 0; c < 2; ++c) {
-        for (int from = 0; from < 64; ++from) {
-            for (int to = 0; to < 64; ++to) {
-                g_history[c][from][to] = 0;
-            }
-        }
+constexpr int HISTORY_MAX = 16384;
+
+struct HistoryTables {
+    int history[2][64][64];
+    int continuation[2][PIECE_INDEX_COUNT][64][PIECE_INDEX_COUNT][64];
+    int capture[PIECE_INDEX_COUNT][64][7];
+    move countermoves[PIECE_INDEX_COUNT][64];
+    bool has_countermove[PIECE_INDEX_COUNT][64];
+};
+
+static thread_local std::unique_ptr<HistoryTables> g_history_tables;
+
+static HistoryTables& history_tables() {
+    if (!g_history_tables) {
+        g_history_tables.reset(new HistoryTables());  // value-initialized: all zero
     }
+    return *g_history_tables;
+}
+
+// Age history tables (call at start of search): halve every entry so recent
+// cutoffs outweigh old ones without forgetting everything
+void age_history() {
+    HistoryTables& tables = history_tables();
+    for (auto& side : tables.history)
+        for (auto& from : side)
+            for (int& entry : from) entry /= 2;
+
+    for (auto& back : tables.continuation)
+        for (auto& prev_piece : back)
+            for (auto& prev_to : prev_piece)
+                for (auto& piece : prev_to)
+                    for (int& entry : piece) entry /= 2;
+
+    for (auto& piece : tables.capture)
+        for (auto& to : piece)
+            for (int& entry : to) entry /= 2;
+}
+
+// Bonus for a cutoff at the given depth (deeper cutoffs are more valuable)
+int history_bonus(int depth) {
+    return std::min(32 * depth * depth + 64 * depth, 2400);
+}
+
+void apply_history_bonus(int& entry, int bonus) {
+    entry += bonus - entry * std::abs(bonus) / HISTORY_MAX;
+}
+
+// Continuation history row for the move played 'back' plies before 'ply'
+// (back = 1 or 2), or nullptr if there is none (root, null move)
+int (*continuation_row(int ply, int back))[64] {
+    if (ply - back < 0) return nullptr;
+    const SearchStackEntry& prev = g_search_stack[ply - back];
+    if (prev.moved_piece < 0) return nullptr;
+    int prev_to = prev.current_move.to_row * 8 + prev.current_move.to_col;
+    return history_tables().continuation[back - 1][prev.moved_piece][prev_to];
 }
 
-// Update history score for a move that caused a cutoff
-// Bonus is depth * depth to favor deeper cutoffs
-void update_history(Color side, const move& m, int depth) {
-    int color_idx = (side == Color::White) ? 0 : 1;
+// Combined butterfly + continuation history for a quiet move
+int quiet_history_score(const Board& board, const move& m, int ply) {
+    const Piece& mover = board.squares[m.from_row][m.from_col];
+    int color_idx = (mover.color == Color::White) ? 0 : 1;
+    int pc = piece_index(mover);
     int from_sq = m.from_row * 8 + m.from_col;
     int to_sq = m.to_row * 8 + m.to_col;
-    
-    // Add depth^2 bonus (deeper cutoffs are more valuable)
-    g_history[color_idx][from_sq][to_sq] += depth * depth;
-    
-    // Cap history values to prevent overflow and keep values reasonable
-    if (g_history[color_idx][from_sq][to_sq] > 10000) {
-        g_history[color_idx][from_sq][to_sq] = 10000;
+
+    int score = history_tables().history[color_idx][from_sq][to_sq];
+    for (int back = 1; back <= 2; ++back) {
+        if (auto row = continuation_row(ply, back)) {
+            score += row[pc][to_sq];
+        }
     }
+    return score;
 }
 
-// Get history score for a move
-int get_history_score(Color side, const move& m) {
-    int color_idx = (side == Color::White) ? 0 : 1;
+// Reward (bonus > 0) or punish (bonus < 0) a quiet move in all quiet tables
+void update_quiet_histories(const Board& board, const move& m, int ply, int bonus) {
+    const Piece& mover = board.squares[m.from_row][m.from_col];
+    int color_idx = (mover.color == Color::White) ? 0 : 1;
+    int pc = piece_index(mover);
     int from_sq = m.from_row * 8 + m.from_col;
     int to_sq = m.to_row * 8 + m.to_col;
-    return g_history[color_idx][from_sq][to_sq];
+
+    apply_history_bonus(history_tables().history[color_idx][from_sq][to_sq], bonus);
+    for (int back = 1; back <= 2; ++back) {
+        if (auto row = continuation_row(ply, back)) {
+            apply_history_bonus(row[pc][to_sq], bonus);
+        }
+    }
+}
+
+// Type of piece captured by m (a pawn for en passant)
+int captured_type_index(const Board& board, const move& m) {
+    const Piece& target = board.squares[m.to_row][m.to_col];
+    if (target.type == PieceType::None) return static_cast<int>(PieceType::Pawn);
+    return static_cast<int>(target.type);
+}
+
+int capture_history_score(const Board& board, const move& m) {
+    int pc = piece_index(board.squares[m.from_row][m.from_col]);
+    return history_tables().capture[pc][m.to_row * 8 + m.to_col][captured_type_index(board, m)];
+}
+
+void update_capture_history(const Board& board, const move& m, int bonus) {
+    int pc = piece_index(board.squares[m.from_row][m.from_col]);
+    apply_history_bonus(history_tables().capture[pc][m.to_row * 8 + m.to_col][captured_type_index(board, m)], bonus);
+}
+
+// Countermove stored for the opponent's move at ply - 1, or nullptr
+const move* get_countermove(int ply) {
+    if (ply < 1) return nullptr;
+    const SearchStackEntry& prev = g_search_stack[ply - 1];
+    if (prev.moved_piece < 0) return nullptr;
+    int prev_to = prev.current_move.to_row * 8 + prev.current_move.to_col;
+    if (!history_tables().has_countermove[prev.moved_piece][prev_to]) return nullptr;
+    return &history_tables().countermoves[prev.moved_piece][prev_to];
+}
+
+void store_countermove(int ply, const move& m) {
+    if (ply < 1) return;
+    const SearchStackEntry& prev = g_search_stack[ply - 1];
+    if (prev.moved_piece < 0) return;
+    int prev_to = prev.current_move.to_row * 8 + prev.current_move.to_col;
+    history_tables().countermoves[prev.moved_piece][prev_to] = m;
+    history_tables().has_countermove[prev.moved_piece][prev_to] = true;
 }
 
 // Check if position has enough material to avoid zugzwang
 // Zugzwang = position where any move worsens the position
 // Common in endgames with only pawns, so we require at least one non-pawn piece
+// The material signature already has the counts, so no board scan is needed
 bool has_non_pawn_material(const Board& board, Color side) {
+    const std::uint64_t pieces =
+        0xF * (material_key_unit(side, PieceType::Knight) | material_key_unit(side, PieceType::Bishop) |
+               material_key_unit(side, PieceType::Rook) | material_key_unit(side, PieceType::Queen));
+    return (board.material_key & pieces) != 0;  // Has knight, bishop, rook, or queen
+}
+
+// Total value of knights, bishops, rooks and queens of one side
+int non_pawn_material(const Board& board, Color side) {
+    static const int values[] = {0, 0, 320, 330, 500, 900, 0};
+    int total = 0;
     for (int row = 0; row < BOARD_SIZE; ++row) {
         for (int col = 0; col < BOARD_SIZE; ++col) {
             const Piece& p = board.squares[row][col];
-            if (p.color == side && 
-                p.type != PieceType::None && 
-                p.type != PieceType::Pawn && 
-                p.type != PieceType::King) {
-                return true;  // Has knight, bishop, rook, or queen
+            if (p.color == side) {
+                total += values[static_cast<int>(p.type)];
             }
         }
     }
-    return false;
+    return total;
 }
 
+// ============================================================================
+// DRAW RECOGNITION - Dead-drawn positions return before any search
+// ============================================================================
+// Some positions are draws no matter what is played: neither side can ever
+// mate (K vs K, KN vs K, KB vs K), or 100 plies have passed without a capture
+// or pawn move. Searching them only burns nodes, so negamax and quiescence
+// return draw_score() straight away. Repetitions are caught one level up, in
+// the move loop, before the repeating move is even searched.
+// ============================================================================
+
+// King vs king, optionally plus a single knight or bishop on either side
+static bool is_insufficient_material(const Board& board) {
+    const std::uint64_t kings = material_key_unit(Color::White, PieceType::King) +
+                                material_key_unit(Color::Black, PieceType::King);
+    const std::uint64_t rest = board.material_key - kings;
+    return rest == 0 ||
+           rest == material_key_unit(Color::White, PieceType::Knight) ||
+           rest == material_key_unit(Color::White, PieceType::Bishop) ||
+           rest == material_key_unit(Color::Black, PieceType::Knight) ||
+           rest == material_key_unit(Color::Black, PieceType::Bishop);
+}
+
+// True if the position is drawn whatever happens next.
+// A mate delivered on the 100th ply still counts, so we don't claim the
+// 50-move draw while in check.
+static bool is_dead_draw(const Board& board) {
+    if (is_insufficient_material(board)) return true;
+    return board.halfmove_clock >= FIFTY_MOVE_PLIES &&
+           !is_in_check(board, board.side_to_move);
+}
+
+// Null move is disabled below this ply while a verification search runs,
+// so the verification can't itself be cut short by a null move
+static thread_local int g_null_move_min_ply = 0;
+
 // DEBUG: verify make_move/unmake_move restore the board perfectly.
 // Enable by compiling with -DDEBUG_UNDO
 static bool boards_equal(const Board& a, const Board& b) {
@@ -279,6 +690,9 @@ static bool boards_equal(const Board& a, const Board& b) {
 
     if (a.en_passant_row != b.en_passant_row) return false;
     if (a.en_passant_col != b.en_passant_col) return false;
+    if (a.zobrist_hash != b.zobrist_hash) return false;
+    if (a.halfmove_clock != b.halfmove_clock) return false;
+    if (a.fullmove_number != b.fullmove_number) return false;
 
     for (int r = 0; r < BOARD_SIZE; ++r) {
         for (int c = 0; c < BOARD_SIZE; ++c) {
@@ -315,6 +729,182 @@ constexpr int MATERIAL_VALUES[] = {
     0    // King (not used in captures)
 };
 
+// ============================================================================
+// STATIC EXCHANGE EVALUATION (SEE) THRESHOLDS
+// ============================================================================
+// Captures that lose material according to SEE (see attacks.cpp) are ordered
+// after quiet moves, skipped in quiescence, and pruned late in the move list
+// of shallow negamax nodes.
+// ============================================================================
+constexpr int BAD_CAPTURE_SCORE = -2000;   // Base ordering score for losing captures
+constexpr int SEE_PRUNE_MAX_DEPTH = 3;     // Prune losing captures in negamax at depth <= 3
+constexpr int SEE_PRUNE_MARGIN = 100;      // ...if SEE < -SEE_PRUNE_MARGIN * depth
+
+// ============================================================================
+// FORWARD PRUNING - Static-eval-driven node pruning (non-PV nodes only)
+// ============================================================================
+// - Reverse futility pruning: at shallow depth, if the static eval beats beta
+//   by a depth-scaled margin, assume the node fails high without searching.
+// - Razoring: at very shallow depth, if the static eval is far below alpha,
+//   drop straight into quiescence and trust a fail-low.
+// - Futility pruning: near the horizon, skip quiet moves that can't lift the
+//   static eval above alpha even with a generous margin.
+//
+// Margins are kept in one struct so they can be tuned without touching the
+// search code.
+// ============================================================================
+struct PruningParams {
+    int rfp_max_depth = 6;        // Reverse futility pruning at depth <= 6
+    int rfp_margin = 90;          // ...if eval - 90 * depth >= beta
+    int razor_max_depth = 2;      // Razoring at depth <= 2
+    int razor_margin = 300;       // ...if eval + 300 * depth < alpha
+    int futility_max_depth = 3;   // Futility pruning at depth <= 3
+    int futility_margin = 120;    // ...if eval + 120 * depth <= alpha
+    int lmp_max_depth = 4;        // Late move pruning at depth <= 4
+    int lmp_base = 3;             // ...after 3 + depth^2 quiet moves (halved if not improving)
+    int probcut_min_depth = 5;    // ProbCut at depth >= 5
+    int probcut_margin = 200;     // ...against beta + 200
+    int probcut_reduction = 4;    // ...with a search 4 plies shallower
+    int singular_min_depth = 6;   // Singular extension verification at depth >= 6
+    int singular_margin = 2;      // ...against tt_value - 2 * depth
+    int iir_min_depth = 4;        // IIR/IID for nodes without a TT move at depth >= 4
+};
+static PruningParams g_pruning;
+
+// ============================================================================
+// NODES WITHOUT A TT MOVE
+// ============================================================================
+// Without a TT move, ordering falls back to heuristics and the node is
+// expensive. Two classic fixes:
+// - Internal iterative reduction (IIR): search the node one ply shallower;
+//   the next iteration will find a TT move stored by this one.
+// - Internal iterative deepening (IID): run a reduced-depth search first,
+//   purely to get a best move into the TT, then search at full depth.
+// ============================================================================
+enum class NoTTMoveMode {
+    None,
+    IIR,
+    IID
+};
+// IIR searched ~5% fewer nodes to depth 7 than IID on our test positions
+static NoTTMoveMode g_no_tt_move_mode = NoTTMoveMode::IIR;
+
+// ============================================================================
+// SEARCH STATISTICS - How much work the search did and how often each
+// pruning technique fired. Reset at the start of find_best_move.
+// ============================================================================
+struct SearchStats {
+    std::uint64_t nodes = 0;            // negamax nodes
+    std::uint64_t qnodes = 0;           // quiescence nodes
+    std::uint64_t rfp_cutoffs = 0;      // reverse futility pruning returns
+    std::uint64_t razor_cutoffs = 0;    // razoring returns
+    std::uint64_t futility_pruned = 0;  // quiet moves skipped by futility pruning
+    std::uint64_t see_pruned = 0;       // losing captures skipped (negamax + quiescence)
+    std::uint64_t lmp_pruned = 0;       // quiet moves skipped by late move pruning
+    std::uint64_t lmr_searches = 0;     // reduced-depth searches
+    std::uint64_t lmr_researches = 0;   // reduced searches that had to be redone at full depth
+    std::uint64_t probcut_tries = 0;    // captures verified by ProbCut
+    std::uint64_t probcut_cutoffs = 0;  // nodes cut by ProbCut
+    std::uint64_t probcut_nodes = 0;    // nodes spent inside ProbCut verification searches
+    std::uint64_t singular_extensions = 0; // TT moves extended as singular
+    std::uint64_t multicut_cutoffs = 0;    // nodes cut because several moves beat beta
+    std::uint64_t iir_reductions = 0;      // nodes reduced because they had no TT move
+    std::uint64_t iid_searches = 0;        // internal iterative deepening searches
+    std::uint64_t null_cutoffs = 0;        // nodes cut by null move pruning
+    std::uint64_t null_verifications = 0;  // null move fail-highs re-checked by a verification search
+    std::uint64_t null_refuted = 0;        // ...where the verification did not confirm the cutoff
+    std::uint64_t draw_cutoffs = 0;        // nodes returned as dead draws (material / 50-move rule)
+    std::uint64_t fail_highs = 0;          // beta cutoffs in negamax
+    std::uint64_t fail_highs_first = 0;    // ...caused by the first move searched
+    std::uint64_t generation_skipped = 0;  // TT move cut off before the move list was generated
+};
+static thread_local SearchStats g_stats;
+
+void print_search_stats() {
+    std::cerr << "Nodes: " << g_stats.nodes << " (qnodes: " << g_stats.qnodes << ")"
+              << " | RFP: " << g_stats.rfp_cutoffs
+              << " | Razor: " << g_stats.razor_cutoffs
+              << " | Futility: " << g_stats.futility_pruned
+              << " | SEE: " << g_stats.see_pruned
+              << " | LMP: " << g_stats.lmp_pruned
+              << " | LMR: " << g_stats.lmr_searches << " (re-searched: " << g_stats.lmr_researches << ")"
+              << " | ProbCut: " << g_stats.probcut_cutoffs << "/" << g_stats.probcut_tries
+              << " (nodes: " << g_stats.probcut_nodes << ")"
+              << " | Singular: " << g_stats.singular_extensions
+              << " | Multi-cut: " << g_stats.multicut_cutoffs
+              << " | IIR: " << g_stats.iir_reductions
+              << " | IID: " << g_stats.iid_searches
+              << " | Null: " << g_stats.null_cutoffs
+              << " (verified: " << g_stats.null_verifications
+              << ", refuted: " << g_stats.null_refuted << ")"
+              << " | Draws: " << g_stats.draw_cutoffs
+              << " | TT-first: " << g_stats.generation_skipped << "\n";
+    long long elapsed = elapsed_ms(std::chrono::steady_clock::now());
+    std::uint64_t total_nodes = g_stats.nodes + g_stats.qnodes;
+    std::cerr << "Total nodes: " << total_nodes
+              << " | Time: " << elapsed << " ms"
+              << " | NPS: " << (elapsed > 0 ? total_nodes * 1000 / elapsed : total_nodes)
+              << " | Clock polls: " << g_time_polls;
+    if (g_search_aborted) {
+        std::cerr << " | Abort overrun: " << g_abort_overrun_ms << " ms";
+    }
+    std::cerr << "\n";
+    if (g_stats.fail_highs > 0) {
+        std::cerr << "Fail-high on first move: "
+                  << (100.0 * g_stats.fail_highs_first / g_stats.fail_highs) << "% of "
+                  << g_stats.fail_highs << " cutoffs\n";
+    }
+}
+
+// ============================================================================
+// LATE MOVE REDUCTIONS - Precomputed logarithmic reduction table
+// ============================================================================
+// Moves late in a well-ordered list rarely turn out best, so we search them
+// at reduced depth first. The reduction grows with both remaining depth and
+// move number: R = 0.75 + ln(depth) * ln(move_number) / 2.25.
+// The table value is then adjusted per move (PV node, improving, history).
+// ============================================================================
+constexpr int LMR_MAX_DEPTH = 64;
+constexpr int LMR_MAX_MOVES = 64;
+static int g_lmr_table[LMR_MAX_DEPTH][LMR_MAX_MOVES];
+
+static void fill_lmr_table() {
+    for (int d = 0; d < LMR_MAX_DEPTH; ++d) {
+        for (int m = 0; m < LMR_MAX_MOVES; ++m) {
+            if (d == 0 || m == 0) {
+                g_lmr_table[d][m] = 0;
+            } else {
+                g_lmr_table[d][m] = static_cast<int>(0.75 + std::log(d) * std::log(m) / 2.25);
+            }
+        }
+    }
+}
+
+// Searches may start on several threads at once
+void init_lmr_table() {
+    static std::once_flag initialized;
+    std::call_once(initialized, fill_lmr_table);
+}
+
+int lmr_reduction(int depth, size_t move_index) {
+    int d = std::min(depth, LMR_MAX_DEPTH - 1);
+    int m = static_cast<int>(std::min(move_index, static_cast<size_t>(LMR_MAX_MOVES - 1)));
+    return g_lmr_table[d][m];
+}
+
+// Number of quiet moves searched before late move pruning kicks in
+int lmp_threshold(int depth, bool improving) {
+    int count = g_pruning.lmp_base + depth * depth;
+    return improving ? count : count / 2;
+}
+
+// True if both moves have the same squares and promotion
+bool same_move(const move& a, const move& b) {
+    return a.from_row == b.from_row && a.from_col == b.from_col &&
+           a.to_row == b.to_row && a.to_col == b.to_col &&
+           a.promotion == b.promotion;
+}
+
 // helper to convert score based on the current player
 int evaluate_for_current_player(const Board& board) {
     // evaluate the board for the current player
@@ -361,18 +951,24 @@ bool is_capture_move(const Board& board, const move& m) {
  * Move ordering priority:
  * 1. TT move (handled separately)
  * 2. Captures ordered by MVV-LVA (Most Valuable Victim - Least Valuable Aggressor)
- * 3. Killer moves (quiet moves that caused cutoffs at this depth)
- * 4. Other quiet moves
+ * 3. Killer moves (quiet moves that caused cutoffs at this ply)
+ * 4. Countermove (quiet move that last refuted the opponent's previous move)
+ * 5. Other quiet moves by history (butterfly + continuation history)
+ * 6. Losing captures
  * 
  * MVV-LVA: Most Valuable Victim - Least Valuable Aggressor
  * - Captures: 10 * value_of_victim - value_of_attacker
  *   Example: PxQ (Pawn takes Queen) = 10*900 - 100 = 8900
  *   Example: RxN (Rook takes Knight) = 10*320 - 500 = 2700
+ *   Capture history adds up to +/-256 to break ties between similar captures
+ * - Losing captures (SEE < 0, e.g. QxP defended by a pawn): BAD_CAPTURE_SCORE + SEE,
+ *   so they are tried after all quiet moves
  * - Promotions: High score (+1000)
  * - Killer moves: Medium score (+800)
- * - Quiet moves: 0 or small positional bonus
+ * - Countermove: +750
+ * - Quiet moves: small positional bonus + scaled history, within +/-700
  */
- int calculate_move_score(const Board& board, const move& m, int depth = 0) {
+ int calculate_move_score(const Board& board, const move& m, int ply = 0) {
     // Check if this is a promotion move
     // Promotions are very valuable, give them high priority
     if (m.promotion != NONE) {
@@ -386,11 +982,19 @@ bool is_capture_move(const Board& board, const move& m) {
     // Check if this is a normal capture (destination square has an enemy piece)
     const Piece& target = board.squares[m.to_row][m.to_col];
     if (target.type != PieceType::None && target.color != board.side_to_move) {
-        // This is a capture! Calculate MVV-LVA score
+        // This is a capture! Only run SEE when the attacker is worth more than
+        // the victim - PxN, NxR etc. can never lose material
         int victim_value = MATERIAL_VALUES[static_cast<int>(target.type)];
+        if (attacker_value > victim_value) {
+            int see = static_exchange_eval(board, m);
+            if (see < 0) {
+                return BAD_CAPTURE_SCORE + see;
+            }
+        }
+        // Calculate MVV-LVA score
         // MVV-LVA formula: 10 * victim - attacker
         // Higher victim value = better, lower attacker value = better
-        return 10 * victim_value - attacker_value;
+        return 10 * victim_value - attacker_value + capture_history_score(board, m) / 64;
     }
     
     // Check for en passant capture
@@ -404,53 +1008,84 @@ bool is_capture_move(const Board& board, const move& m) {
         // En passant captures a pawn (value 100)
         // Attacker is also a pawn (value 100)
         int victim_value = MATERIAL_VALUES[static_cast<int>(PieceType::Pawn)];
-        return 10 * victim_value - attacker_value;  // 10 * 100 - 100 = 900
+        return 10 * victim_value - attacker_value  // 10 * 100 - 100 = 900
+               + capture_history_score(board, m) / 64;
     }
 
-    // Quiet-moves
-    // These only matter when moves are otherwise equal (no capture/promo)
-    // Keep magnitudes small so move ordering still dominates
-
-    // Encourage castling (king moves 2 squares)
-    if (moving_piece.type == PieceType::King && std::abs(m.to_col - m.from_col) == 2) {
-        return 50;
+    // KILLER MOVE BONUS: Quiet moves that caused cutoffs at this ply
+    // Give them high priority (after captures but before other quiet moves)
+    if (is_killer(ply, m)) {
+        return 800;  // High score for killer moves
     }
 
-    // Discourage early king moves (non-castling)
-    if (moving_piece.type == PieceType::King) {
-        return -20;
+    // COUNTERMOVE BONUS: the quiet move that refuted the opponent's last move
+    // the last time we saw it
+    const move* counter = get_countermove(ply);
+    if (counter != nullptr && same_move(*counter, m)) {
+        return 750;
     }
 
-    // Discourage early rook moves a bit ( pointless before development)
-    if (moving_piece.type == PieceType::Rook) {
-        return -10;
-    }
+    // Quiet-moves
+    // These only matter when moves are otherwise equal (no capture/promo)
+    // Keep magnitudes small so move ordering still dominates
+    int positional = 0;
 
-    // Encourage developing knights and bishops off the back rank
-    if (moving_piece.type == PieceType::Knight || moving_piece.type == PieceType::Bishop) {
+    if (moving_piece.type == PieceType::King && std::abs(m.to_col - m.from_col) == 2) {
+        // Encourage castling (king moves 2 squares)
+        positional = 50;
+    } else if (moving_piece.type == PieceType::King) {
+        // Discourage early king moves (non-castling)
+        positional = -20;
+    } else if (moving_piece.type == PieceType::Rook) {
+        // Discourage early rook moves a bit ( pointless before development)
+        positional = -10;
+    } else if (moving_piece.type == PieceType::Knight || moving_piece.type == PieceType::Bishop) {
+        // Encourage developing knights and bishops off the back rank
         // White back rank = row 0, Black back rank = row 7 in your board representation
         if ((moving_piece.color == Color::White && m.from_row == 0) ||
             (moving_piece.color == Color::Black && m.from_row == 7)) {
-            return 10;
+            positional = 10;
         }
     }
 
-    // KILLER MOVE BONUS: Quiet moves that caused cutoffs at this depth
-    // Give them high priority (after captures but before other quiet moves)
-    if (is_killer(depth, m)) {
-        return 800;  // High score for killer moves
-    }
-
     // HISTORY HEURISTIC: Use historical success of quiet moves
     // Moves that caused cutoffs in the past are likely good here too
-    int history_score = get_history_score(board.side_to_move, m);
-    if (history_score > 0) {
-        // Scale history to be between 0 and 700 (below killer moves)
-        return std::min(700, history_score / 15);
+    // Scale history to stay between -700 and 700 (below killer moves)
+    int history_score = quiet_history_score(board, m, ply);
+    return std::max(-700, std::min(700, positional + history_score / 70));
+}
+
+/*
+ * order_moves
+ * -----------
+ * Sorts moves[first..] by calculate_move_score, highest first.
+ * Each move is scored exactly once (the comparator used to re-score both
+ * moves on every comparison, which gets expensive now that SEE is involved).
+ * Scores go into the search stack's buffer for this ply, and the lists are
+ * short, so a stable insertion sort does the job without allocating. They
+ * stay there, sorted along with the moves, for the caller to reuse.
+ */
+void order_moves(const Board& board, std::vector<move>& moves, size_t first, int ply) {
+    if (moves.size() <= first) return;
+
+    std::vector<int>& scores = g_search_stack[ply].scores;
+    scores.resize(moves.size());
+    for (size_t i = first; i < moves.size(); ++i) {
+        scores[i] = calculate_move_score(board, moves[i], ply);
     }
 
-    // Quiet move (no capture, no promotion, not a killer, no history)
-    return 0;
+    for (size_t i = first + 1; i < moves.size(); ++i) {
+        const int score = scores[i];
+        const move m = moves[i];
+        size_t j = i;
+        while (j > first && scores[j - 1] < score) {
+            scores[j] = scores[j - 1];
+            moves[j] = moves[j - 1];
+            --j;
+        }
+        scores[j] = score;
+        moves[j] = m;
+    }
 }
 
 /*
@@ -466,38 +1101,54 @@ bool is_capture_move(const Board& board, const move& m) {
  *  - otherwise, we try capture moves and update alpha.
  *
  * qs_depth limits how deep we search to prevent explosion in tactical positions.
+ * ply is the distance from the root (index into the search stack).
  */
- int quiescence_search(Board& board, int alpha, int beta, int qs_depth) {
+ int quiescence_search(Board& board, int alpha, int beta, int qs_depth, int ply) {
+    ++g_stats.qnodes;
+
     // TIME CHECK: Abort search if time limit exceeded
-    if (time_is_up()) {
+    if (node_time_is_up()) {
         g_search_aborted = true;
         return evaluate_for_current_player(board);  // Return current eval
     }
 
+    // DRAW RECOGNITION: nothing to resolve in a dead-drawn position
+    if (ply > 0 && is_dead_draw(board)) {
+        ++g_stats.draw_cutoffs;
+        return draw_score(ply);
+    }
+
     // If quiescence depth exhausted, return static eval
     if (qs_depth <= 0) {
         return evaluate_for_current_player(board);
     }
 
+    SearchStackEntry& ss = g_search_stack[ply];
+    Undo& undo = g_search_stack.undo[ply];
+    std::vector<move>& moves = ss.moves[QS_MOVES];
+
     // If side to move is in check, we MUST consider all legal evasions.
     // Stand-pat is not legal while in check.
     const bool in_check = is_in_check(board, board.side_to_move);
+    ss.in_check = in_check;
     if (in_check) {
-        std::vector<move> moves = generate_legal_moves(board);
+        generate_legal_moves(board, moves);
 
         // If no legal moves, it's mate/stalemate
         if (moves.empty()) {
-            return evaluate_terminal(board);
+            return evaluate_terminal(board, ply);
         }
 
         for (const move& m : moves) {
 #ifdef DEBUG_UNDO
             const Board before = board;
 #endif
-            Undo undo;
+            ss.current_move = m;
+            ss.moved_piece = piece_index(board.squares[m.from_row][m.from_col]);
+
             make_move(board, m, undo);
 
-            int score = -quiescence_search(board, -beta, -alpha, qs_depth - 1);
+            int score = -quiescence_search(board, -beta, -alpha, qs_depth - 1, ply + 1);
 
             unmake_move(board, m, undo);
 
@@ -520,31 +1171,45 @@ bool is_capture_move(const Board& board, const move& m) {
     if (stand_pat >= beta) return beta;
     if (stand_pat > alpha) alpha = stand_pat;
 
-    std::vector<move> moves = generate_legal_moves(board);
+    generate_legal_moves(board, moves);
 
     if (moves.empty()) {
-        return evaluate_terminal(board);
+        return evaluate_terminal(board, ply);
     }
 
-    for (const move& m : moves) {
+    // Try the most promising captures first (MVV-LVA, losing captures last)
+    order_moves(board, moves, 0, ply);
+    const std::vector<int>& order_scores = g_search_stack[ply].scores;
+
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const move& m = moves[i];
         bool dominated = !is_capture_move(board, m);
+
+        // SEE PRUNING: skip captures that lose material (e.g. QxP defended by a pawn).
+        // Standing pat is already at least as good as a losing exchange.
+        // Ordering already ran SEE: only losing captures score below BAD_CAPTURE_SCORE
+        if (!dominated && m.promotion == NONE && order_scores[i] < BAD_CAPTURE_SCORE) {
+            ++g_stats.see_pruned;
+            continue;
+        }
         
         // Also consider moves that give check (might be mate!)
         if (dominated) {
-            Undo check_undo;
-            make_move(board, m, check_undo);
+            make_move(board, m, undo);
             bool gives_check = is_in_check(board, board.side_to_move);
-            unmake_move(board, m, check_undo);
+            unmake_move(board, m, undo);
             if (!gives_check) continue;  // Skip quiet non-checking moves
         }
 
 #ifdef DEBUG_UNDO
         const Board before = board;
 #endif
-        Undo undo;
+        ss.current_move = m;
+        ss.moved_piece = piece_index(board.squares[m.from_row][m.from_col]);
+
         make_move(board, m, undo);
 
-        int score = -quiescence_search(board, -beta, -alpha, qs_depth - 1);
+        int score = -quiescence_search(board, -beta, -alpha, qs_depth - 1, ply + 1);
 
         unmake_move(board, m, undo);
 
@@ -581,19 +1246,36 @@ bool is_capture_move(const Board& board, const move& m) {
 // DEPTH: number of moves to look ahead
 // ALPHA: best score for the current player
 // BETA: best score for the opponent
-int negamax(Board& board, int depth, int alpha, int beta) {
+// PLY: distance from the root (index into the search stack)
+// A singular extension verification search sets excluded_move/has_excluded
+// in this ply's search stack entry; that move is then skipped.
+int negamax(Board& board, int depth, int alpha, int beta, int ply) {
+    ++g_stats.nodes;
+
     // TIME CHECK: Abort search if time limit exceeded
-    if (time_is_up()) {
+    if (node_time_is_up()) {
         g_search_aborted = true;
         return 0;  // Return immediately with neutral score
     }
 
     // BASE CASE
     // If depth is exhausted, switch to quiescence search (captures only)
-    if (depth == 0) {
-        return quiescence_search(board, alpha, beta, MAX_QS_DEPTH);
+    if (depth == 0 || ply >= MAX_PLY) {
+        return quiescence_search(board, alpha, beta, MAX_QS_DEPTH, ply);
+    }
+
+    // DRAW RECOGNITION: cut dead-drawn subtrees before probing or generating anything
+    if (ply > 0 && is_dead_draw(board)) {
+        ++g_stats.draw_cutoffs;
+        return draw_score(ply);
     }
 
+    SearchStackEntry& ss = g_search_stack[ply];
+    const bool excluded_search = ss.has_excluded;
+
+    // Null-window searches are non-PV nodes; only those get forward pruned
+    const bool is_pv = (beta - alpha > 1);
+
     // Save original alpha for determining TT bound type later
     const int original_alpha = alpha;
     
@@ -601,12 +1283,22 @@ int negamax(Board& board, int depth, int alpha, int beta) {
     // TRANSPOSITION TABLE PROBE
     // =========================================================================
     // Check if we've seen this position before at sufficient depth
-    std::uint64_t pos_hash = compute_zobrist(board);
-    TTentry* tt_entry = g_tt.probe(pos_hash);
+    std::uint64_t pos_hash = board.zobrist_hash;
+    TTentry tt_copy;  // The table is shared between threads, so we read a copy
+    const TTentry* tt_entry = g_tt.probe(pos_hash, tt_copy) ? &tt_copy : nullptr;
+    if (tt_entry) tt_copy.value = score_from_tt(tt_copy.value, ply);
     move tt_move;  // Best move from TT (for move ordering)
     bool has_tt_move = false;
+
+    // Copy what singular extensions need - the entry may be overwritten by
+    // deeper searches before we get to use it
+    const int tt_depth = tt_entry ? tt_entry->depth : -1;
+    const int tt_value = tt_entry ? tt_entry->value : 0;
+    const TTflag tt_flag = tt_entry ? tt_entry->flag : TT_UPPER;
     
-    if (tt_entry != nullptr && tt_entry->depth >= depth) {
+    // An excluded-move search is asking a different question about this
+    // position, so the stored result for the full position doesn't apply
+    if (!excluded_search && tt_entry != nullptr && tt_entry->depth >= depth) {
         // We have a cached result at sufficient depth
         if (tt_entry->flag == TT_EXACT) {
             // Exact score - can return immediately
@@ -639,68 +1331,253 @@ int negamax(Board& board, int depth, int alpha, int beta) {
     // This gives ~2 plies of extra effective depth.
     // =========================================================================
     const bool in_check_before_moves = is_in_check(board, board.side_to_move);
+    ss.in_check = in_check_before_moves;
+
+    // =========================================================================
+    // STATIC EVAL + FORWARD PRUNING
+    // =========================================================================
+    // Static eval is meaningless in check (we must respond to the threat)
+    const int static_eval = in_check_before_moves ? NEG_INF : evaluate_for_current_player(board);
+    ss.static_eval = static_eval;
+
+    // IMPROVING: is our eval better than two plies ago (our previous move)?
+    // Non-improving nodes get pruned and reduced more aggressively.
+    const bool improving = !in_check_before_moves &&
+                           (ply < 2 ||
+                            g_search_stack[ply - 2].static_eval == NEG_INF ||
+                            static_eval > g_search_stack[ply - 2].static_eval);
+
+    if (!is_pv && !in_check_before_moves) {
+        // REVERSE FUTILITY PRUNING: we are so far above beta that a quiet
+        // position is unlikely to drop below it within a few plies
+        if (depth <= g_pruning.rfp_max_depth &&
+            std::abs(beta) < MATE_THRESHOLD &&
+            static_eval - g_pruning.rfp_margin * depth >= beta) {
+            ++g_stats.rfp_cutoffs;
+            return static_eval;
+        }
+
+        // RAZORING: hopelessly below alpha - only tactics can save us, so
+        // let quiescence decide and trust it if it confirms the fail-low
+        if (depth <= g_pruning.razor_max_depth &&
+            static_eval + g_pruning.razor_margin * depth < alpha) {
+            int razor_score = quiescence_search(board, alpha - 1, alpha, MAX_QS_DEPTH, ply);
+            if (razor_score < alpha && !g_search_aborted) {
+                ++g_stats.razor_cutoffs;
+                return razor_score;
+            }
+        }
+    }
+
     
     // Only apply null move at sufficient depth (need depth > reduction + 1)
     // Also avoid null move when we might be in zugzwang (low material)
     if (!in_check_before_moves && 
+        !excluded_search &&
         depth >= NULL_MOVE_MIN_DEPTH + NULL_MOVE_REDUCTION &&  // Ensure positive search depth
         beta < POS_INF - 1000 &&  // Not searching for mate
         beta > NEG_INF + 1000 &&  // Not in a losing position
+        ply >= g_null_move_min_ply &&  // Not inside a null move verification search
         has_non_pawn_material(board, board.side_to_move)) {
         
-        // Make null move: just switch sides without moving
-        Board null_board = board;
-        null_board.side_to_move = (board.side_to_move == Color::White) ? Color::Black : Color::White;
-        null_board.en_passant_row = -1;  // Clear en passant after null move
-        null_board.en_passant_col = -1;
-        
         // Search with reduced depth and null window
         int null_depth = depth - 1 - NULL_MOVE_REDUCTION;
+        ss.moved_piece = -1;  // No continuation history after a pass
         if (null_depth > 0) {  // Extra safety check
-            int null_score = -negamax(null_board, null_depth, -beta, -beta + 1);
+            // Make null move in place: just switch sides without moving
+            Undo& undo = g_search_stack.undo[ply];
+            make_null_move(board, undo);
+            int null_score = -negamax(board, null_depth, -beta, -beta + 1, ply + 1);
+            unmake_null_move(board, undo);
             
             // If null move search fails high (score >= beta), we can cut off
             // The idea: if we can pass and still be >= beta, actually moving will be even better
             if (null_score >= beta && !g_search_aborted) {
-                return beta;  // Trust the null move result
+                bool verify = depth >= NULL_VERIFY_DEPTH ||
+                              non_pawn_material(board, board.side_to_move) <= NULL_VERIFY_MATERIAL;
+                if (!verify) {
+                    ++g_stats.null_cutoffs;
+                    return beta;  // Trust the null move result
+                }
+
+                // VERIFICATION SEARCH: in zugzwang-prone positions passing may
+                // be the only "good" move, so confirm with a real reduced search
+                ++g_stats.null_verifications;
+                int saved_min_ply = g_null_move_min_ply;
+                g_null_move_min_ply = ply + 3 * null_depth / 4 + 1;
+                int verify_score = negamax(board, null_depth, beta - 1, beta, ply);
+                g_null_move_min_ply = saved_min_ply;
+                ss.static_eval = static_eval;
+
+                if (verify_score >= beta && !g_search_aborted) {
+                    ++g_stats.null_cutoffs;
+                    return beta;
+                }
+                ++g_stats.null_refuted;
             }
         }
     }
 
-    // Generate all legal moves
-    std::vector<move> legal_moves = generate_legal_moves(board);
+    // =========================================================================
+    // INTERNAL ITERATIVE REDUCTION / DEEPENING (no TT move)
+    // =========================================================================
+    if (!has_tt_move && !excluded_search && depth >= g_pruning.iir_min_depth) {
+        if (g_no_tt_move_mode == NoTTMoveMode::IIR) {
+            ++g_stats.iir_reductions;
+            --depth;
+        } else if (g_no_tt_move_mode == NoTTMoveMode::IID) {
+            ++g_stats.iid_searches;
+            negamax(board, depth - 2, alpha, beta, ply);
+            ss.static_eval = static_eval;
+
+            TTentry iid_entry;
+            if (g_tt.probe(pos_hash, iid_entry) && iid_entry.has_move) {
+                tt_move = iid_entry.best_move;
+                has_tt_move = true;
+            }
+        }
+    }
 
-    // Terminal node: checkmate or stalemate
-    // Pass depth so engine prefers faster checkmates
-    if (legal_moves.empty()) {
-        return evaluate_terminal(board, depth);
+    const int probcut_beta = beta + g_pruning.probcut_margin;
+    const int probcut_depth = depth - g_pruning.probcut_reduction;
+    const bool probcut_node = !is_pv && !in_check_before_moves &&
+        !excluded_search &&
+        depth >= g_pruning.probcut_min_depth &&
+        std::abs(beta) < MATE_THRESHOLD &&
+        !(tt_entry != nullptr && tt_entry->depth >= probcut_depth && tt_entry->value < probcut_beta);
+
+    const bool singular_node = has_tt_move && !excluded_search && ply > 0 &&
+        depth >= g_pruning.singular_min_depth &&
+        tt_flag != TT_UPPER &&
+        tt_depth >= depth - 3 &&
+        std::abs(tt_value) < MATE_THRESHOLD;
+
+    // =========================================================================
+    // TT MOVE BEFORE GENERATION
+    // =========================================================================
+    // A legal TT move is searched before the move list exists. When it cuts
+    // off - most of the time at non-PV nodes - generation is skipped entirely;
+    // otherwise the list is generated behind it after its search. ProbCut and
+    // singular extensions need the full list first, so those nodes generate
+    // up front.
+    // =========================================================================
+    std::vector<move>& legal_moves = ss.moves[excluded_search ? SINGULAR_MOVES : MAIN_MOVES];
+    bool moves_generated = true;
+    if (has_tt_move && !excluded_search && !probcut_node && !singular_node && is_legal(board, tt_move)) {
+        legal_moves.assign(1, tt_move);
+        moves_generated = false;
+    } else {
+        // Generate all legal moves into this ply's buffer
+        generate_legal_moves(board, legal_moves);
+
+        // Terminal node: checkmate or stalemate
+        // Pass depth so engine prefers faster checkmates
+        if (legal_moves.empty()) {
+            return evaluate_terminal(board, ply);
+        }
+    }
+
+    // =========================================================================
+    // PROBCUT
+    // =========================================================================
+    // At deep non-PV nodes, a capture that wins enough material usually proves
+    // a cutoff. Verify good captures (by SEE) with a shallow search against a
+    // raised beta; if one fails high, the full-depth search would most likely
+    // fail high too. Skipped when the TT already says the shallow search fails.
+    // =========================================================================
+    if (probcut_node) {
+
+        const std::uint64_t nodes_before = g_stats.nodes + g_stats.qnodes;
+
+        for (const move& candidate : legal_moves) {
+            if (!is_capture_move(board, candidate) && candidate.promotion == NONE) continue;
+            // The capture must win enough on its own to reach the raised beta
+            if (!see_ge(board, candidate, probcut_beta - static_eval)) continue;
+
+            ++g_stats.probcut_tries;
+
+            ss.current_move = candidate;
+            ss.moved_piece = piece_index(board.squares[candidate.from_row][candidate.from_col]);
+
+            Undo& undo = g_search_stack.undo[ply];
+            make_move(board, candidate, undo);
+            std::uint64_t child_hash = board.zobrist_hash;
+            add_position_to_history(child_hash);
+
+            // Cheap quiescence pre-check, then the reduced-depth verification
+            int score = -quiescence_search(board, -probcut_beta, -probcut_beta + 1, MAX_QS_DEPTH, ply + 1);
+            if (score >= probcut_beta) {
+                score = -negamax(board, probcut_depth, -probcut_beta, -probcut_beta + 1, ply + 1);
+            }
+
+            remove_last_position_from_history();
+            unmake_move(board, candidate, undo);
+
+            if (g_search_aborted) break;
+
+            if (score >= probcut_beta) {
+                ++g_stats.probcut_cutoffs;
+                g_stats.probcut_nodes += g_stats.nodes + g_stats.qnodes - nodes_before;
+                g_tt.store(pos_hash, probcut_depth + 1, score_to_tt(score, ply), TT_LOWER, &candidate);
+                return score;
+            }
+        }
+
+        g_stats.probcut_nodes += g_stats.nodes + g_stats.qnodes - nodes_before;
     }
 
     // =========================================================================
     // MOVE ORDERING: TT move first, then MVV-LVA
     // =========================================================================
     // The TT move (if valid) is likely the best move from previous search
-    if (has_tt_move) {
+    bool tt_move_found = !moves_generated;  // searched on its own, already at the front
+    if (has_tt_move && moves_generated) {
         // Find and move TT move to front if it's in the legal moves list
         for (size_t i = 0; i < legal_moves.size(); ++i) {
-            if (legal_moves[i].from_row == tt_move.from_row &&
-                legal_moves[i].from_col == tt_move.from_col &&
-                legal_moves[i].to_row == tt_move.to_row &&
-                legal_moves[i].to_col == tt_move.to_col &&
-                legal_moves[i].promotion == tt_move.promotion) {
+            if (same_move(legal_moves[i], tt_move)) {
                 // Swap TT move to front
                 std::swap(legal_moves[0], legal_moves[i]);
+                tt_move_found = true;
                 break;
             }
         }
     }
     
-    // Sort remaining moves (skip first if it's TT move) by MVV-LVA + killers
-    auto sort_start = has_tt_move ? legal_moves.begin() + 1 : legal_moves.begin();
-    std::stable_sort(sort_start, legal_moves.end(), 
-        [&board, depth](const move& a, const move& b) {
-            return calculate_move_score(board, a, depth) > calculate_move_score(board, b, depth);
-        });
+    // Sort remaining moves (skip first if it's TT move) by MVV-LVA/SEE + killers
+    order_moves(board, legal_moves, tt_move_found ? 1 : 0, ply);
+
+    // =========================================================================
+    // SINGULAR EXTENSION
+    // =========================================================================
+    // If the TT move is much better than every alternative, it is "singular"
+    // and worth a deeper look. Verify by searching all other moves at reduced
+    // depth against a beta just below the TT score:
+    // - everything fails low  -> TT move is singular, extend it by one ply
+    // - the raised beta is still >= beta -> several moves beat beta (multi-cut)
+    // =========================================================================
+    int singular_extension = 0;
+    if (tt_move_found && singular_node) {
+
+        const int singular_beta = tt_value - g_pruning.singular_margin * depth;
+        const int singular_depth = (depth - 1) / 2;
+        ss.excluded_move = legal_moves.front();
+        ss.has_excluded = true;
+        int singular_score = negamax(board, singular_depth, singular_beta - 1, singular_beta, ply);
+        ss.has_excluded = false;
+
+        if (!g_search_aborted) {
+            if (singular_score < singular_beta) {
+                ++g_stats.singular_extensions;
+                singular_extension = 1;
+            } else if (singular_beta >= beta) {
+                ++g_stats.multicut_cutoffs;
+                return singular_beta;
+            }
+        }
+
+        // The verification search overwrote this ply's slot
+        ss.static_eval = static_eval;
+    }
 
     int best_score = NEG_INF;
     move best_move = legal_moves.front();  // Track best move for TT storage
@@ -708,21 +1585,62 @@ int negamax(Board& board, int depth, int alpha, int beta) {
     // Use the check status we already computed for null move pruning
     const bool in_check = in_check_before_moves;
 
+    // FUTILITY PRUNING: quiet moves can't raise the eval by more than the margin
+    const bool futility_node = !is_pv && !in_check &&
+                               depth <= g_pruning.futility_max_depth &&
+                               std::abs(alpha) < MATE_THRESHOLD &&
+                               static_eval + g_pruning.futility_margin * depth <= alpha;
+
+    // LATE MOVE PRUNING: at low depth, quiet moves past a count threshold are skipped
+    const bool lmp_node = !is_pv && !in_check && depth <= g_pruning.lmp_max_depth;
+    const int lmp_limit = lmp_threshold(depth, improving);
+    int quiet_count = 0;
+
+    // Moves that were searched without causing a cutoff get a history malus
+    // once some other move does
+    constexpr int MAX_TRIED = 64;
+    move quiets_tried[MAX_TRIED];
+    move captures_tried[MAX_TRIED];
+    int quiets_tried_count = 0;
+    int captures_tried_count = 0;
+    int moves_searched = 0;
+
     // Search all moves
     for (size_t move_index = 0; move_index < legal_moves.size(); ++move_index) {
         const move& candidate = legal_moves[move_index];
+
+        if (excluded_search && same_move(candidate, ss.excluded_move)) {
+            continue;
+        }
         
         // LMR checks - must be done BEFORE make_move changes the board
         bool is_capture = is_capture_move(board, candidate);
         bool is_promotion = (candidate.promotion != NONE);
-        bool can_reduce = (move_index >= 4) && (depth >= 3) && 
+        bool can_reduce = (move_index >= 3) && (depth >= 3) && 
                           !is_capture && !is_promotion && !in_check;
+        bool is_quiet = !is_capture && !is_promotion;
+        if (is_quiet) ++quiet_count;
+        const int move_history = is_quiet ? quiet_history_score(board, candidate, ply) : 0;
+
+        // SEE PRUNING: near the horizon, skip late captures that clearly lose material.
+        // Never prune the first move so best_move/best_score are always set.
+        if (move_index > 0 && is_capture && !is_promotion && !in_check &&
+            depth <= SEE_PRUNE_MAX_DEPTH &&
+            best_score > -MATE_THRESHOLD &&
+            !see_ge(board, candidate, -SEE_PRUNE_MARGIN * depth)) {
+            ++g_stats.see_pruned;
+            continue;
+        }
         
 #ifdef DEBUG_UNDO
         const Board before = board;
 #endif
+        // Record the move on the stack so children can see what they reply to
+        ss.current_move = candidate;
+        ss.moved_piece = piece_index(board.squares[candidate.from_row][candidate.from_col]);
+
         // Apply move in-place and remember everything needed to undo it
-        Undo undo;
+        Undo& undo = g_search_stack.undo[ply];
         make_move(board, candidate, undo);
 
         // =====================================================================
@@ -734,16 +1652,42 @@ int negamax(Board& board, int depth, int alpha, int beta) {
         bool gives_check = is_in_check(board, board.side_to_move);
         int extension = gives_check ? 1 : 0;
 
+        // Singular TT move (always at index 0 when found)
+        if (move_index == 0 && singular_extension > 0) {
+            extension = 1;
+        }
+
+        // Skip futile quiet moves (checks are never futile). The first move is
+        // always searched so best_move stays valid.
+        if (futility_node && move_index > 0 && !is_capture && !is_promotion && !gives_check) {
+            unmake_move(board, candidate, undo);
+            ++g_stats.futility_pruned;
+            best_score = std::max(best_score, static_eval + g_pruning.futility_margin * depth);
+            continue;
+        }
+
+        // Skip late quiet moves once enough of them have been tried
+        if (lmp_node && move_index > 0 && is_quiet && !gives_check &&
+            quiet_count > lmp_limit && best_score > -MATE_THRESHOLD) {
+            unmake_move(board, candidate, undo);
+            ++g_stats.lmp_pruned;
+            continue;
+        }
+
         // REPETITION DETECTION: Check if this position has been seen before
         // Compute hash of the new position and check history
-        std::uint64_t pos_hash = compute_zobrist(board);
-        int repetition_count = count_repetitions(pos_hash);
+        std::uint64_t pos_hash = board.zobrist_hash;
+        int repetition_count = count_repetitions(pos_hash, board.halfmove_clock);
+
+        // 50-MOVE RULE: the game is drawn once 100 reversible plies have been
+        // played - unless this move mates, so checking moves are still searched
+        bool fifty_move_draw = board.halfmove_clock >= FIFTY_MOVE_PLIES && !gives_check;
         
         int score;
-        if (repetition_count >= 2) {
-            // Position would appear 3+ times = forced draw
+        if (repetition_count >= 2 || fifty_move_draw) {
+            // Position would appear 3+ times (or 50-move rule) = forced draw
             // Apply CONTEMPT: treat draws as slightly bad (we want to keep playing!)
-            score = -(DRAW_SCORE - CONTEMPT);  // With contempt, draws are negative
+            score = -draw_score(ply + 1);
         } else {
             // Late Move Reductions (LMR): Search late quiet moves at reduced depth first
             // Don't reduce if the move gives check
@@ -755,16 +1699,28 @@ int negamax(Board& board, int depth, int alpha, int beta) {
             
             if (can_reduce_this_move) {
                 // LMR: Reduced depth search with null window
-                int reduction = 1 + (depth > 6 ? 1 : 0);  // Reduce by 1-2 plies
-                score = -negamax(board, depth - 1 - reduction + extension, -alpha - 1, -alpha);
+                // Reduce less at PV nodes, when improving, for killers and for
+                // moves with a good history; reduce more otherwise
+                int reduction = lmr_reduction(depth, move_index);
+                if (is_pv) reduction -= 1;
+                if (!improving) reduction += 1;
+                if (is_killer(ply, candidate)) reduction -= 1;
+                reduction -= move_history / 8192;
+
+                // Never drop straight into quiescence and never extend
+                int reduced_depth = std::max(1, std::min(depth - 1, depth - 1 - reduction));
+                ++g_stats.lmr_searches;
+                score = -negamax(board, reduced_depth, -alpha - 1, -alpha, ply + 1);
                 
-                // If reduced search beats alpha, re-search at full depth
+                // If reduced search beats alpha, re-search at full depth (only
+                // a re-search when the first search was actually reduced)
                 if (score > alpha) {
-                    score = -negamax(board, depth - 1 + extension, -beta, -alpha);
+                    if (reduced_depth < depth - 1) ++g_stats.lmr_researches;
+                    score = -negamax(board, depth - 1 + extension, -beta, -alpha, ply + 1);
                 }
             } else {
                 // Full depth search (with extension if giving check)
-                score = -negamax(board, depth - 1 + extension, -beta, -alpha);
+                score = -negamax(board, depth - 1 + extension, -beta, -alpha, ply + 1);
             }
             
             remove_last_position_from_history();
@@ -801,24 +1757,68 @@ int negamax(Board& board, int depth, int alpha, int beta) {
             alpha = score;
         }
 
+        ++moves_searched;
+
         // Alpha-beta cutoff
         if (alpha >= beta) {
-            // KILLER MOVE: Store quiet moves that cause cutoffs
-            // These are likely good in sibling positions at the same depth
-            if (!is_capture && !is_promotion) {
-                store_killer(depth, candidate);
-                // HISTORY HEURISTIC: Update history for this quiet move
-                update_history(board.side_to_move, candidate, depth);
+            ++g_stats.fail_highs;
+            if (moves_searched == 1) ++g_stats.fail_highs_first;
+            if (!moves_generated) ++g_stats.generation_skipped;
+
+            if (!g_search_aborted) {
+                const int bonus = history_bonus(depth);
+                if (is_quiet) {
+                    // KILLER MOVE + COUNTERMOVE: Store quiet moves that cause cutoffs
+                    // These are likely good in sibling positions at the same ply
+                    store_killer(ply, candidate);
+                    store_countermove(ply, candidate);
+                    // HISTORY HEURISTIC: reward this quiet move, punish the ones tried before it
+                    update_quiet_histories(board, candidate, ply, bonus);
+                    for (int i = 0; i < quiets_tried_count; ++i) {
+                        update_quiet_histories(board, quiets_tried[i], ply, -bonus);
+                    }
+                } else if (is_capture) {
+                    update_capture_history(board, candidate, bonus);
+                }
+                // Captures that were tried first but didn't cut off were overrated
+                for (int i = 0; i < captures_tried_count; ++i) {
+                    update_capture_history(board, captures_tried[i], -bonus);
+                }
             }
             break;
         }
+
+        if (is_quiet && quiets_tried_count < MAX_TRIED) {
+            quiets_tried[quiets_tried_count++] = candidate;
+        } else if (is_capture && captures_tried_count < MAX_TRIED) {
+            captures_tried[captures_tried_count++] = candidate;
+        }
+
+        // The TT move did not cut off: generate the other moves behind it
+        if (!moves_generated) {
+            moves_generated = true;
+            generate_legal_moves(board, legal_moves);
+            for (size_t i = 0; i < legal_moves.size(); ++i) {
+                if (same_move(legal_moves[i], tt_move)) {
+                    std::swap(legal_moves[0], legal_moves[i]);
+                    break;
+                }
+            }
+            order_moves(board, legal_moves, 1, ply);
+        }
     }
 
     // =========================================================================
     // TRANSPOSITION TABLE STORE
     // =========================================================================
+    // Excluded-move searches may have skipped every move
+    if (best_score == NEG_INF) {
+        return alpha;
+    }
+
     // Store the result for future lookups (if search wasn't aborted)
-    if (!g_search_aborted) {
+    // Excluded-move results don't describe the full position, so never store them
+    if (!g_search_aborted && !excluded_search) {
         TTflag flag;
         if (best_score <= original_alpha) {
             // Failed low - this is an upper bound (we didn't find anything better)
@@ -831,7 +1831,7 @@ int negamax(Board& board, int depth, int alpha, int beta) {
             flag = TT_EXACT;
         }
         
-        g_tt.store(pos_hash, depth, best_score, flag, &best_move);
+        g_tt.store(pos_hash, depth, score_to_tt(best_score, ply), flag, &best_move);
     }
 
     return best_score;
@@ -862,12 +1862,8 @@ SearchResult select_move(const Board& board, int depth, int init_alpha = NEG_INF
     // This was missing - without sorting, alpha-beta is much less effective
     // We use the same calculate_move_score() function that negamax() uses
     // Good moves (captures, promotions, killers) are tried first, leading to more cutoffs
-    std::stable_sort(legal_moves.begin(), legal_moves.end(), 
-        [&board, depth](const move& a, const move& b) {
-            // Sort in descending order (highest score first)
-            // Moves with higher scores will be searched first
-            return calculate_move_score(board, a, depth) > calculate_move_score(board, b, depth);
-        });
+    // Moves with higher scores will be searched first
+    order_moves(board, legal_moves, 0, 0);
 
     // initialise best_move to the first move in the vector
     move best_move = legal_moves.front();
@@ -879,8 +1875,8 @@ SearchResult select_move(const Board& board, int depth, int init_alpha = NEG_INF
 
     // loop through each legal move
     for (const auto& candidate : legal_moves) {
-        // TIME CHECK: Abort search if time limit exceeded
-        if (time_is_up()) {
+        // TIME CHECK: Abort search if time limit exceeded (or stop / node budget)
+        if (search_limit_reached()) {
             g_search_aborted = true;
             break;  // Return best move found so far
         }
@@ -889,6 +1885,9 @@ SearchResult select_move(const Board& board, int depth, int init_alpha = NEG_INF
 #ifdef DEBUG_UNDO
         const Board before = temp;
 #endif
+        g_search_stack[0].current_move = candidate;
+        g_search_stack[0].moved_piece = piece_index(temp.squares[candidate.from_row][candidate.from_col]);
+
         // make a copy of the current board
         Undo undo;
         // apply candidate move to the copy
@@ -897,22 +1896,24 @@ SearchResult select_move(const Board& board, int depth, int init_alpha = NEG_INF
         
         // REPETITION DETECTION at root level
         // Check if this move leads to a repeated position
-        std::uint64_t pos_hash = compute_zobrist(temp);
-        int repetition_count = count_repetitions(pos_hash);
+        std::uint64_t pos_hash = temp.zobrist_hash;
+        int repetition_count = count_repetitions(pos_hash, temp.halfmove_clock);
+        bool fifty_move_draw = temp.halfmove_clock >= FIFTY_MOVE_PLIES &&
+                               !is_in_check(temp, temp.side_to_move);
         
         int score;
-        if (repetition_count >= 2) {
-            // This move would cause threefold repetition = draw
+        if (repetition_count >= 2 || fifty_move_draw) {
+            // This move would cause threefold repetition (or a 50-move draw)
             // Apply CONTEMPT: treat draws as slightly bad (we want to keep playing!)
-            score = -(DRAW_SCORE - CONTEMPT);
-            std::cerr << "Note: Move leads to repetition, applying contempt\n";
+            score = -draw_score(1);
+            std::cerr << "Note: Move leads to a draw, applying contempt\n";
         } else {
             // Track this position during search
             add_position_to_history(pos_hash);
             // call the recursive negamax search on resulting position
             // next_board = child position (DEPTH - 1)
             // -alpha and -beta to flip for the opponent
-            score = -negamax(temp, depth - 1, -beta, -alpha);
+            score = -negamax(temp, depth - 1, -beta, -alpha, 1);
             remove_last_position_from_history();
             
             // STRONGER repetition penalty - avoid repeating when we have ANY advantage
@@ -951,25 +1952,55 @@ SearchResult select_move(const Board& board, int depth, int init_alpha = NEG_INF
 
 } // namespace
 
-// Mate detection threshold - scores near CHECKMATE_SCORE indicate forced mate
-constexpr int MATE_THRESHOLD = 90000;    // CHECKMATE_SCORE is 100000
+// Move ordering score as used by the search (for the microbenchmarks)
+int move_ordering_score(const Board& board, const move& m, int ply) {
+    return calculate_move_score(board, m, ply);
+}
+
+// Nodes searched so far by the current (or last) search
+std::uint64_t get_search_node_count() {
+    return g_stats.nodes + g_stats.qnodes;
+}
+
+// The reply we expect to BEST_MOVE: the TT move of the position after it,
+// if there is one and it is legal there
+bool get_ponder_move(const Board& board, const move& best_move, move& ponder_move) {
+    Board after = board;
+    make_move(after, best_move);
+    TTentry entry;
+    if (!g_tt.probe(after.zobrist_hash, entry) || !entry.has_move) return false;
+
+    if (!is_legal(after, entry.best_move)) return false;
+    ponder_move = entry.best_move;
+    return true;
+}
+
 // Minimum advantage to consider "clearly winning" for early stop
 constexpr int CLEARLY_WINNING = 300;     // ~3 pawns or a piece up
+// Score drop between iterations that counts as a fail low for time management
+constexpr int FAIL_LOW_MARGIN = 30;
 
-// FIND_BEST_MOVE FUNCTION WITH ITERATIVE DEEPENING AND TIME CONTROL
+// ITERATIVE DEEPENING WITH TIME CONTROL
 // BOARD: current board position
 // MAX_DEPTH: maximum number of moves to look ahead
-// TIME_LIMIT_MS: time limit in milliseconds (0 = no limit)
+// BUDGET: hard limit aborts the search (0 = no limit); soft limit (0 = none)
+//         stops starting new iterations, scaled by best-move stability and fail-lows;
+//         max_nodes (0 = none) aborts after that many nodes
 // returns the best move for the current player
 // Uses iterative deepening: searches depth 1, then 2, etc. until time runs out
 // Always returns a valid move (at minimum, depth 1 result or first legal move)
-move find_best_move(const Board& board, int max_depth, int time_limit_ms) {
+static move iterative_deepening(const Board& board, int max_depth, const TimeBudget& budget) {
     // Initialize time control
-    set_time_limit(time_limit_ms);
+    set_time_limit(budget.hard_ms);
+    set_node_limit(budget.max_nodes);
     
+    init_lmr_table();
+
     // Clear killer moves and history from previous search
+    // Killers are position specific; history tables are aged, not cleared
     clear_killers();
-    clear_history();
+    age_history();
+    g_stats = SearchStats{};
     
     // CHECK if depth is valid
     if (max_depth < 1) {
@@ -991,6 +2022,21 @@ move find_best_move(const Board& board, int max_depth, int time_limit_ms) {
     // Always have a fallback move (first legal move)
     move best_move = legal_moves.front();
     int best_score = NEG_INF;
+
+    // FORCED REPLY: with only one legal move there is nothing to think about
+    // It is still reported as a (depth 0, static eval) iteration, so UCI gets
+    // its info line and anytime mode publishes the move
+    if (legal_moves.size() == 1 && budget.soft_ms > 0 && !search_pondering()) {
+        std::cerr << "Only one legal move, playing it without searching\n";
+        if (g_iteration_callback != nullptr) {
+            g_iteration_callback(best_move, 0, eval_for_us);
+        }
+        print_search_stats();
+        return best_move;
+    }
+
+    // Soft-limit bookkeeping: how many iterations in a row kept the best move
+    int best_move_stability = 0;
     
     // =========================================================================
     // ITERATIVE DEEPENING WITH ASPIRATION WINDOWS
@@ -1003,12 +2049,13 @@ move find_best_move(const Board& board, int max_depth, int time_limit_ms) {
     
     for (int depth = 1; depth <= max_depth; ++depth) {
         // Check time before starting new depth
-        if (time_is_up()) {
-            std::cerr << "Time limit reached before depth " << depth << "\n";
+        if (search_limit_reached()) {
+            std::cerr << "Search limit reached before depth " << depth << "\n";
             break;
         }
         
         SearchResult result;
+        bool failed_low = false;  // Score dropped below the aspiration window
         
         // Use aspiration windows only after depth 4 with a valid previous score
         // This provides speedup without the instability at low depths
@@ -1027,6 +2074,7 @@ move find_best_move(const Board& board, int max_depth, int time_limit_ms) {
             int asp_beta = std::min(best_score + delta, POS_INF);
             
             result = select_move(board, depth, asp_alpha, asp_beta);
+            failed_low = !g_search_aborted && result.score <= asp_alpha;
             
             // If search failed outside window and wasn't aborted, re-search with full window
             if (!g_search_aborted && (result.score <= asp_alpha || result.score >= asp_beta)) {
@@ -1037,9 +2085,20 @@ move find_best_move(const Board& board, int max_depth, int time_limit_ms) {
         
         // Only update best move if search completed without timeout
         if (!g_search_aborted) {
+            if (depth > 1 && result.score < best_score - FAIL_LOW_MARGIN) {
+                failed_low = true;
+            }
+            if (depth > 1 && same_move(result.best_move, best_move)) {
+                ++best_move_stability;
+            } else {
+                best_move_stability = 0;
+            }
             best_move = result.best_move;
             best_score = result.score;
             std::cerr << "Completed depth " << depth << " (score: " << best_score << ")\n";
+            if (g_iteration_callback != nullptr) {
+                g_iteration_callback(best_move, depth, best_score);
+            }
             
             // EARLY TERMINATION: Stop if we found a forced mate
             if (best_score >= MATE_THRESHOLD) {
@@ -1055,15 +2114,49 @@ move find_best_move(const Board& board, int max_depth, int time_limit_ms) {
                           << ", search: " << best_score << "), stopping search.\n";
                 break;
             }
+
+            // SOFT LIMIT: don't start another iteration once the (scaled)
+            // target time is used up. The target itself is at most half the
+            // hard limit: the next iteration usually takes longer than all
+            // previous ones together, and an aborted iteration gives us
+            // nothing. Instability and fail-lows may still stretch it past that
+            if (budget.soft_ms > 0 && !search_pondering()) {
+                double scale = time_scale(best_move_stability, failed_low);
+                long long base = budget.hard_ms > 0 ? std::min(budget.soft_ms, budget.hard_ms / 2) : budget.soft_ms;
+                long long soft = static_cast<long long>(base * scale);
+                if (budget.hard_ms > 0) soft = std::min(soft, static_cast<long long>(budget.hard_ms));
+                long long elapsed = elapsed_ms(std::chrono::steady_clock::now());
+                if (elapsed >= soft) {
+                    std::cerr << "Soft time limit reached after depth " << depth << " (" << elapsed
+                              << " of " << soft << " ms, stability " << best_move_stability
+                              << (failed_low ? ", failed low" : "") << ")\n";
+                    break;
+                }
+            }
         } else {
             std::cerr << "Search aborted at depth " << depth << "\n";
             break;  // Stop iterating if search was aborted
         }
     }
     
+    print_search_stats();
     return best_move;
 }
 
+// Fixed time limit: the search runs until it is aborted (or max_depth)
+move find_best_move(const Board& board, int max_depth, int time_limit_ms) {
+    TimeBudget budget;
+    budget.hard_ms = time_limit_ms;
+    return iterative_deepening(board, max_depth, budget);
+}
+
+// Clock-managed search: soft and hard limits from the time manager
+move find_best_move(const Board& board, int max_depth, const TimeControl& tc) {
+    TimeBudget budget = allocate_time(tc);
+    std::cerr << "Time budget: soft " << budget.soft_ms << " ms, hard " << budget.hard_ms << " ms\n";
+    return iterative_deepening(board, max_depth, budget);
+}
+
 // Backward-compatible overload for existing code
 move find_best_move(const Board& board, int depth) {
     // No time limit - use original behavior
@@ -1,6 +1,8 @@
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <cstdio>
+#include <mutex>
 
 #include "include/move.h"
 
@@ -42,7 +44,14 @@ std::string move_to_uci(move m) {
     return uci;
 }
 
+// The move file may be written several times per run (anytime mode, the
+// deadline watchdog) while the harness is polling it, so a reader must never
+// see a half-written file: we write a temporary file next to it and rename it
+// over the target, which replaces it atomically. Writers are serialized so
+// they don't share the temporary file.
 bool write_move_to_file(move m, std::string path) {
+    static std::mutex write_mutex;
+
     // 1. Convert move to UCI string
     std::string uci = move_to_uci(m);
     if (uci.empty()) {
@@ -50,11 +59,14 @@ bool write_move_to_file(move m, std::string path) {
         return false;
     }
 
-    // 2. Open the output file (overwrite mode)
-    std::ofstream file(path);
+    std::lock_guard<std::mutex> lock(write_mutex);
+    const std::string tmp_path = path + ".tmp";
+
+    // 2. Open the temporary file (overwrite mode)
+    std::ofstream file(tmp_path);
 
     if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << path << std::endl;
+        std::cerr << "Error: Could not open file " << tmp_path << std::endl;
         return false;
     }
 
@@ -63,6 +75,17 @@ bool write_move_to_file(move m, std::string path) {
 
     // 4. Close the file
     file.close();
+    if (!file) {
+        std::cerr << "Error: Could not write file " << tmp_path << std::endl;
+        return false;
+    }
+
+    // 5. Move it into place
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "Error: Could not rename " << tmp_path << " to " << path << std::endl;
+        std::remove(tmp_path.c_str());
+        return false;
+    }
 
     return true;
 }
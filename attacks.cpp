@@ -1,4 +1,7 @@
 #include "board.h"
+#include "attacks.h"
+#include <algorithm>
+#include <cstdint>
 
 namespace {
 
@@ -98,4 +101,209 @@ bool is_in_check(const Board& board, Color color) {
 
     Color enemy = (color == Color::White) ? Color::Black : Color::White;
     return is_attacked(board, king_row, king_col, enemy);
-}
\ No newline at end of file
+}
+
+// ============================================================================
+// STATIC EXCHANGE EVALUATION (SEE)
+// ============================================================================
+// SEE plays out the full sequence of captures on the destination square of a
+// move, always recapturing with the least valuable attacker, and returns the
+// material balance for the side making the first capture. Each side may stop
+// capturing at any point, so a losing recapture is never forced.
+//
+// We don't have bitboards, so attackers are found by scanning rays outward
+// from the target square. Pieces that have already captured are marked in a
+// 64-bit mask of removed squares, which the scans treat as empty: that
+// uncovers x-ray attackers (e.g. a rook behind a rook on the same file)
+// without copying or modifying the board.
+// ============================================================================
+
+namespace {
+
+// SEE piece values, index corresponds to PieceType enum.
+// The king is given a huge value so it only ever captures last.
+constexpr int SEE_VALUES[] = {
+    0,     // None
+    100,   // Pawn
+    320,   // Knight
+    330,   // Bishop
+    500,   // Rook
+    900,   // Queen
+    20000  // King
+};
+
+inline int see_value(PieceType type) {
+    return SEE_VALUES[static_cast<int>(type)];
+}
+
+inline std::uint64_t square_bit(int row, int col) {
+    return std::uint64_t{1} << (row * BOARD_SIZE + col);
+}
+
+// The piece on (row, col), or an empty square if it has left the exchange
+inline Piece see_piece(const Board& board, std::uint64_t removed, int row, int col) {
+    if (removed & square_bit(row, col)) return {PieceType::None, Color::None};
+    return board.squares[row][col];
+}
+
+// Find the least valuable piece of 'by_color' attacking (target_row, target_col),
+// ignoring the squares in REMOVED. Returns false if there is none, otherwise
+// sets attacker_row/attacker_col.
+bool least_valuable_attacker(const Board& board, std::uint64_t removed, int target_row, int target_col,
+                             Color by_color, int& attacker_row, int& attacker_col) {
+    int best_value = 1000000;
+    attacker_row = -1;
+    attacker_col = -1;
+
+    auto consider = [&](int r, int c) {
+        int v = see_value(board.squares[r][c].type);
+        if (v < best_value) {
+            best_value = v;
+            attacker_row = r;
+            attacker_col = c;
+        }
+    };
+
+    // Pawns: a pawn can't be beaten by anything cheaper, return immediately
+    int pawn_dir = (by_color == Color::White) ? -1 : 1;
+    int pawn_row = target_row + pawn_dir;
+    for (int col : {target_col - 1, target_col + 1}) {
+        if (is_valid_square(pawn_row, col)) {
+            const Piece p = see_piece(board, removed, pawn_row, col);
+            if (p.type == PieceType::Pawn && p.color == by_color) {
+                attacker_row = pawn_row;
+                attacker_col = col;
+                return true;
+            }
+        }
+    }
+
+    // Knights
+    static const int knight_offsets[8][2] = {{2, 1}, {2, -1}, {-2, 1}, {-2, -1}, {1, 2}, {1, -2}, {-1, 2}, {-1, -2}};
+    for (auto& offset : knight_offsets) {
+        int r = target_row + offset[0];
+        int c = target_col + offset[1];
+        if (is_valid_square(r, c)) {
+            const Piece p = see_piece(board, removed, r, c);
+            if (p.type == PieceType::Knight && p.color == by_color) {
+                attacker_row = r;
+                attacker_col = c;
+                return true;
+            }
+        }
+    }
+
+    // Sliding pieces: first piece on each ray
+    static const int diag_dirs[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    for (auto& dir : diag_dirs) {
+        for (int dist = 1; dist < BOARD_SIZE; ++dist) {
+            int r = target_row + dir[0] * dist;
+            int c = target_col + dir[1] * dist;
+            if (!is_valid_square(r, c)) break;
+            const Piece p = see_piece(board, removed, r, c);
+            if (p.type != PieceType::None) {
+                if (p.color == by_color && (p.type == PieceType::Bishop || p.type == PieceType::Queen)) {
+                    consider(r, c);
+                }
+                break;
+            }
+        }
+    }
+
+    static const int straight_dirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    for (auto& dir : straight_dirs) {
+        for (int dist = 1; dist < BOARD_SIZE; ++dist) {
+            int r = target_row + dir[0] * dist;
+            int c = target_col + dir[1] * dist;
+            if (!is_valid_square(r, c)) break;
+            const Piece p = see_piece(board, removed, r, c);
+            if (p.type != PieceType::None) {
+                if (p.color == by_color && (p.type == PieceType::Rook || p.type == PieceType::Queen)) {
+                    consider(r, c);
+                }
+                break;
+            }
+        }
+    }
+
+    // King last (only if nothing else attacks)
+    if (attacker_row == -1) {
+        static const int king_offsets[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+        for (auto& offset : king_offsets) {
+            int r = target_row + offset[0];
+            int c = target_col + offset[1];
+            if (is_valid_square(r, c)) {
+                const Piece p = see_piece(board, removed, r, c);
+                if (p.type == PieceType::King && p.color == by_color) {
+                    attacker_row = r;
+                    attacker_col = c;
+                    return true;
+                }
+            }
+        }
+    }
+
+    return attacker_row != -1;
+}
+
+} // anonymous namespace
+
+int static_exchange_eval(const Board& board, const move& m) {
+    const Piece& mover = board.squares[m.from_row][m.from_col];
+    const Piece& target = board.squares[m.to_row][m.to_col];
+
+    // Squares whose pieces have joined the exchange (and so left their square)
+    std::uint64_t removed = 0;
+
+    int gain[40];
+    int d = 0;
+
+    bool en_passant = mover.type == PieceType::Pawn &&
+                      m.from_col != m.to_col &&
+                      target.type == PieceType::None;
+
+    gain[0] = en_passant ? see_value(PieceType::Pawn) : see_value(target.type);
+    if (en_passant) {
+        removed |= square_bit(m.from_row, m.to_col);
+    }
+
+    // The piece now standing on the target square (and next to be captured)
+    PieceType on_target = mover.type;
+    if (m.promotion == QUEEN) {
+        gain[0] += see_value(PieceType::Queen) - see_value(PieceType::Pawn);
+        on_target = PieceType::Queen;
+    }
+    removed |= square_bit(m.from_row, m.from_col);
+
+    Color side = (mover.color == Color::White) ? Color::Black : Color::White;
+
+    int attacker_row = 0;
+    int attacker_col = 0;
+    while (d < 38) {
+        ++d;
+        // Speculative score if 'side' captures the piece on the target square
+        gain[d] = see_value(on_target) - gain[d - 1];
+
+        // Neither side can improve by continuing - stop early
+        if (std::max(-gain[d - 1], gain[d]) < 0) break;
+
+        if (!least_valuable_attacker(board, removed, m.to_row, m.to_col, side, attacker_row, attacker_col)) {
+            break;
+        }
+
+        on_target = board.squares[attacker_row][attacker_col].type;
+        removed |= square_bit(attacker_row, attacker_col);
+        side = (side == Color::White) ? Color::Black : Color::White;
+    }
+
+    // Negamax the gain list back to the root; either side may stand pat
+    while (--d) {
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+    }
+
+    return gain[0];
+}
+
+bool see_ge(const Board& board, const move& m, int threshold) {
+    return static_exchange_eval(board, m) >= threshold;
+}
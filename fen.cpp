@@ -0,0 +1,194 @@
+#include "fen.h"
+#include "zobrist_h.h"
+#include <cctype>
+#include <sstream>
+#include <vector>
+
+const char* const STARTING_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+namespace {
+
+// FEN letters, index corresponds to PieceType enum (White = upper case)
+constexpr char PIECE_LETTERS[] = {' ', 'P', 'N', 'B', 'R', 'Q', 'K'};
+
+bool piece_from_letter(char c, Piece& piece) {
+    char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    for (int type = 1; type <= 6; ++type) {
+        if (PIECE_LETTERS[type] == upper) {
+            piece.type = static_cast<PieceType>(type);
+            piece.color = (c == upper) ? Color::White : Color::Black;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool has_piece(const Board& board, int row, int col, PieceType type, Color color) {
+    const Piece& p = board.squares[row][col];
+    return p.type == type && p.color == color;
+}
+
+// Field 1: ranks 8 to 1 separated by '/', digits for runs of empty squares
+bool parse_placement(const std::string& field, Board& board) {
+    int row = BOARD_SIZE - 1;
+    int col = 0;
+    for (char c : field) {
+        if (c == '/') {
+            if (col != BOARD_SIZE || row == 0) return false;
+            --row;
+            col = 0;
+        } else if (c >= '1' && c <= '8') {
+            col += c - '0';
+            if (col > BOARD_SIZE) return false;
+        } else {
+            Piece piece;
+            if (col >= BOARD_SIZE || !piece_from_letter(c, piece)) return false;
+            board.squares[row][col++] = piece;
+        }
+    }
+    return row == 0 && col == BOARD_SIZE;
+}
+
+bool parse_counter(const std::string& field, int& value) {
+    if (field.empty() || field.size() > 6) return false;
+    int parsed = 0;
+    for (char c : field) {
+        if (!std::isdigit(static_cast<unsigned char>(c))) return false;
+        parsed = parsed * 10 + (c - '0');
+    }
+    value = parsed;
+    return true;
+}
+
+} // namespace
+
+bool board_from_fen(const std::string& fen, Board& board) {
+    std::istringstream in(fen);
+    std::vector<std::string> fields;
+    std::string field;
+    while (fields.size() < 6 && in >> field) {
+        fields.push_back(field);
+    }
+    if (fields.size() < 4) return false;
+
+    Board result;
+    if (!parse_placement(fields[0], result)) return false;
+
+    // Exactly one king per side, and no pawns on the back ranks
+    int white_kings = 0, black_kings = 0;
+    for (int row = 0; row < BOARD_SIZE; ++row) {
+        for (int col = 0; col < BOARD_SIZE; ++col) {
+            const Piece& p = result.squares[row][col];
+            if (p.type == PieceType::King) {
+                (p.color == Color::White ? white_kings : black_kings)++;
+            }
+            if (p.type == PieceType::Pawn && (row == 0 || row == BOARD_SIZE - 1)) return false;
+        }
+    }
+    if (white_kings != 1 || black_kings != 1) return false;
+
+    // Field 2: side to move
+    if (fields[1] == "w") {
+        result.side_to_move = Color::White;
+    } else if (fields[1] == "b") {
+        result.side_to_move = Color::Black;
+    } else {
+        return false;
+    }
+
+    // Field 3: castling rights ("-" or a subset of KQkq)
+    result.white_can_castle_kingside = false;
+    result.white_can_castle_queenside = false;
+    result.black_can_castle_kingside = false;
+    result.black_can_castle_queenside = false;
+    if (fields[2] != "-") {
+        for (char c : fields[2]) {
+            switch (c) {
+                case 'K': result.white_can_castle_kingside = true; break;
+                case 'Q': result.white_can_castle_queenside = true; break;
+                case 'k': result.black_can_castle_kingside = true; break;
+                case 'q': result.black_can_castle_queenside = true; break;
+                default: return false;
+            }
+        }
+    }
+    // A right is only meaningful with king and rook on their original squares
+    const bool white_king_home = has_piece(result, 0, 4, PieceType::King, Color::White);
+    const bool black_king_home = has_piece(result, 7, 4, PieceType::King, Color::Black);
+    result.white_can_castle_kingside &= white_king_home && has_piece(result, 0, 7, PieceType::Rook, Color::White);
+    result.white_can_castle_queenside &= white_king_home && has_piece(result, 0, 0, PieceType::Rook, Color::White);
+    result.black_can_castle_kingside &= black_king_home && has_piece(result, 7, 7, PieceType::Rook, Color::Black);
+    result.black_can_castle_queenside &= black_king_home && has_piece(result, 7, 0, PieceType::Rook, Color::Black);
+
+    // Field 4: en passant target square, behind a pawn that just moved two squares
+    if (fields[3] != "-") {
+        if (fields[3].size() != 2) return false;
+        int col = fields[3][0] - 'a';
+        int row = fields[3][1] - '1';
+        Color mover = (result.side_to_move == Color::White) ? Color::Black : Color::White;
+        int expected_row = (mover == Color::White) ? 2 : 5;
+        int pawn_row = (mover == Color::White) ? 3 : 4;
+        if (col < 0 || col >= BOARD_SIZE || row != expected_row ||
+            !has_piece(result, pawn_row, col, PieceType::Pawn, mover)) {
+            return false;
+        }
+        result.en_passant_row = row;
+        result.en_passant_col = col;
+    }
+
+    // Fields 5 and 6: halfmove clock and fullmove number, optional (EPD has neither)
+    int halfmove = 0;
+    int fullmove = 1;
+    if (fields.size() >= 5 && parse_counter(fields[4], halfmove)) {
+        if (fields.size() >= 6 && !parse_counter(fields[5], fullmove)) return false;
+    }
+    result.halfmove_clock = halfmove;
+    result.fullmove_number = fullmove < 1 ? 1 : fullmove;
+
+    result.zobrist_hash = compute_zobrist(result);
+    result.material_key = compute_material_key(result);
+    board = result;
+    return true;
+}
+
+std::string board_to_fen(const Board& board) {
+    std::string fen;
+    for (int row = BOARD_SIZE - 1; row >= 0; --row) {
+        int empty = 0;
+        for (int col = 0; col < BOARD_SIZE; ++col) {
+            const Piece& p = board.squares[row][col];
+            if (p.type == PieceType::None) {
+                ++empty;
+                continue;
+            }
+            if (empty > 0) {
+                fen += static_cast<char>('0' + empty);
+                empty = 0;
+            }
+            char c = PIECE_LETTERS[static_cast<int>(p.type)];
+            fen += (p.color == Color::Black) ? static_cast<char>(std::tolower(static_cast<unsigned char>(c))) : c;
+        }
+        if (empty > 0) fen += static_cast<char>('0' + empty);
+        if (row > 0) fen += '/';
+    }
+
+    fen += (board.side_to_move == Color::White) ? " w " : " b ";
+
+    std::string castling;
+    if (board.white_can_castle_kingside) castling += 'K';
+    if (board.white_can_castle_queenside) castling += 'Q';
+    if (board.black_can_castle_kingside) castling += 'k';
+    if (board.black_can_castle_queenside) castling += 'q';
+    fen += castling.empty() ? "-" : castling;
+
+    if (board.en_passant_row != -1) {
+        fen += ' ';
+        fen += static_cast<char>('a' + board.en_passant_col);
+        fen += static_cast<char>('1' + board.en_passant_row);
+    } else {
+        fen += " -";
+    }
+
+    fen += ' ' + std::to_string(board.halfmove_clock) + ' ' + std::to_string(board.fullmove_number);
+    return fen;
+}
@@ -10,4 +10,13 @@ bool is_attacked(const Board& board, int target_row, int target_col, Color by_co
 // Check if the king of the given color is in check
 bool is_in_check(const Board& board, Color color);
 
+// Static Exchange Evaluation: material balance (centipawns) for the side to move
+// after the full capture sequence on m's destination square, assuming both
+// sides always recapture with their least valuable attacker.
+// Positive = winning exchange, negative = losing exchange.
+int static_exchange_eval(const Board& board, const move& m);
+
+// True if static_exchange_eval(board, m) >= threshold
+bool see_ge(const Board& board, const move& m, int threshold);
+
 #endif // ATTACK_DETECTION_H
\ No newline at end of file
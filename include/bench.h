@@ -0,0 +1,20 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// Search benchmark: every built-in position is searched to DEPTH plies with
+// no time limit, starting from an empty transposition table. Nothing depends
+// on the clock, so the total node count is a signature of the search: it
+// stays the same from run to run (and under perf or valgrind) and changes
+// whenever search or evaluation behaviour does. Prints the nodes per
+// position, then total nodes, wall time and NPS.
+// Returns false if a built-in position fails to parse.
+bool run_bench(int depth);
+
+// Throughput scaling of concurrent searches: the bench positions are searched
+// to DEPTH on 1, 2, 4, ... threads up to MAX_THREADS (0 = one per core), each
+// thread on its own position, all sharing the transposition table as server
+// mode does. Reports NPS, speed-up and efficiency (speed-up / threads) for each
+// thread count. Node counts vary with the thread count and from run to run.
+bool bench_scaling(int depth, int max_threads);
+
+#endif // BENCH_H
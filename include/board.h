@@ -41,6 +41,9 @@ it contains:
 2. which side is to move
 3. castling rights
 4. en passant information
+5. halfmove clock (plies since the last capture or pawn move, for the 50-move rule)
+6. fullmove number (starts at 1, incremented after each Black move)
+7. material signature (how many of each piece each side has)
 */
 
 struct Board {
@@ -57,9 +60,23 @@ struct Board {
     int en_passant_row = -1;
     int en_passant_col = -1;
 
+    // Plies since the last capture or pawn move; 100 = draw by the 50-move rule.
+    // Also bounds how far back a repetition can be.
+    int halfmove_clock = 0;
+    // Move number as written in FEN: starts at 1, incremented after Black moves
+    int fullmove_number = 1;
+
     std::uint64_t zobrist_hash = 0;
+    // Material signature: one 4-bit count per (color, piece type), see material_key_unit()
+    std::uint64_t material_key = 0;
 };
 
+/* Material signature unit for one piece: adding/subtracting it counts the piece in or out.
+   White piece types use nibbles 1-6, Black ones nibbles 7-12. */
+constexpr std::uint64_t material_key_unit(Color color, PieceType type) {
+    return std::uint64_t{1} << (4 * ((color == Color::Black ? 6 : 0) + static_cast<int>(type)));
+}
+
 /* The undo structure stores what is necessary to restore the board so we don't have to make copies
 
 it stores:
@@ -69,6 +86,8 @@ it stores:
 4. whose turn it was before the move
 5. en passant before the move
 6. whether the move was an en passant capture
+7. the halfmove clock and fullmove number before the move
+8. the material signature before the move
 */
 
 struct Undo 
@@ -86,27 +105,56 @@ struct Undo
     // True iff the move being undone was an en passant capture.
     // Needed because the captured pawn is not on the destination square.
     bool was_en_passant = false;
+    int halfmove_clock = 0;
+    int fullmove_number = 1;
 
     std::uint64_t zobrist_hash=0;
+    std::uint64_t material_key=0;
 };
 
 Board make_starting_position();
+/* material signature of a board built from scratch*/
+std::uint64_t compute_material_key(const Board& board);
 /* make move with undo*/
 void make_move(Board& board, const move& m, Undo& undo);
 /* used in places where no need to have undo*/
 void make_move(Board& board, const move& m);
 /*restores to the state before the make move*/
 void unmake_move( Board& board, const move& m, const Undo& undo);
+/* passes the turn (null move): flips side to move, clears en passant, updates the hash*/
+void make_null_move(Board& board, Undo& undo);
+/*restores to the state before make_null_move*/
+void unmake_null_move(Board& board, const Undo& undo);
 std::vector<move> generate_legal_moves(const Board& board);
+/* same, but fills (and reuses the capacity of) the caller's buffer*/
+void generate_legal_moves(const Board& board, std::vector<move>& moves);
+/* true if m follows the movement rules for the side to move (may leave its king in check)*/
+bool is_pseudo_legal(const Board& board, const move& m);
+/* true if m is one of generate_legal_moves(board), checked without generating the list*/
+bool is_legal(const Board& board, const move& m);
 
 
 int evaluate_board(const Board& board);
 int evaluate_terminal(const Board& board);
-int evaluate_terminal(const Board& board, int depth);  // Depth-adjusted for faster mates
+int evaluate_terminal(const Board& board, int ply);  // Ply-adjusted for faster mates
 
 // Time-managed search with iterative deepening
 move find_best_move(const Board& board, int max_depth, int time_limit_ms);
 // Backward-compatible overload (no time limit)
 move find_best_move(const Board& board, int depth);
 
+// Called by find_best_move after every completed iteration with that
+// iteration's best move (nullptr = no callback)
+using IterationCallback = void (*)(const move& best_move, int depth, int score);
+void set_iteration_callback(IterationCallback callback);
+
+// Make the running search return as soon as possible (callable from any
+// thread). The request sticks until reset_search_stop() is called.
+void request_search_stop();
+void reset_search_stop();
+// While pondering the search ignores its time limits; clear it on a ponder hit
+void set_search_pondering(bool pondering);
+// Predicted opponent reply to best_move (from the transposition table)
+bool get_ponder_move(const Board& board, const move& best_move, move& ponder_move);
+
 #endif // BOARD_H
@@ -0,0 +1,19 @@
+#ifndef FEN_H
+#define FEN_H
+
+#include "board.h"
+#include <string>
+
+// FEN of the standard starting position
+extern const char* const STARTING_FEN;
+
+// Set up BOARD from a FEN string. The halfmove and fullmove fields may be
+// left out (EPD); anything after them is ignored. Castling rights whose king
+// or rook is not on its square are dropped.
+// Returns false (and leaves BOARD alone) if the string is not a valid position.
+bool board_from_fen(const std::string& fen, Board& board);
+
+// FEN of BOARD, including the halfmove clock and fullmove number
+std::string board_to_fen(const Board& board);
+
+#endif // FEN_H
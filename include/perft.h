@@ -0,0 +1,62 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "board.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Perft: count the leaf nodes of the legal move tree to a fixed depth.
+//
+// The counts of well-known positions are published, so a mismatch pinpoints
+// a move generation bug (divide shows which root move is off), and the
+// nodes per second measure generator speed. The last ply is bulk counted:
+// its nodes are the size of the legal move list, nothing is made on the board.
+
+// Optional cache of subtree counts, keyed by position hash and remaining depth.
+// Shared by all perft threads without locks: an entry is two words, and the
+// first holds the key XORed with the second. A torn write (words from two
+// different stores) fails that check and reads as a miss.
+class PerftTable
+{
+    public:
+    explicit PerftTable(std::size_t mb);
+
+    bool probe(std::uint64_t key, int depth, std::uint64_t& nodes) const;
+    void store(std::uint64_t key, int depth, std::uint64_t nodes);
+
+    private:
+    struct Entry {
+        std::atomic<std::uint64_t> check{0};  // key ^ data
+        std::atomic<std::uint64_t> data{0};   // nodes << 8 | depth; depth 0 = empty
+    };
+    std::unique_ptr<Entry[]> table;
+    std::size_t mask = 0;
+};
+
+// Leaf nodes DEPTH plies below BOARD. TABLE may be nullptr.
+std::uint64_t perft(Board& board, int depth, PerftTable* table = nullptr);
+
+// Perft on THREADS threads (0 = one per core). The moves of the first two
+// plies become tasks that idle threads steal from each other's queues; every
+// task works on its own Board. ROOT_COUNTS (optional) receives the count
+// under each move of generate_legal_moves(board), in that order.
+std::uint64_t parallel_perft(const Board& board, int depth, int threads, PerftTable* table = nullptr,
+                             std::vector<std::uint64_t>* root_counts = nullptr);
+
+// Perft of BOARD with one line per root move, then totals, time and speed
+std::uint64_t perft_divide(const Board& board, int depth, int threads, PerftTable* table = nullptr);
+
+// Time parallel_perft with 1, 2, 4, ... threads up to MAX_THREADS (0 = one per
+// core) and report speed-up and efficiency (speed-up / threads). Each run gets
+// a fresh HASH_MB table (0 = none).
+void perft_scaling(const Board& board, int depth, int max_threads, std::size_t hash_mb);
+
+// Run the built-in positions with known counts up to MAX_DEPTH plies (each
+// position stops at its deepest known count) on THREADS threads.
+// HASH_MB = 0 disables the cache. Returns false if any count is wrong.
+bool run_perft_suite(int max_depth, int threads, std::size_t hash_mb);
+
+#endif // PERFT_H
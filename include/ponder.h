@@ -0,0 +1,27 @@
+#ifndef PONDER_H
+#define PONDER_H
+
+#include "board.h"
+#include <string>
+
+// Pondering for the one-process-per-move mode.
+//
+// The transposition table is kept in a hash file between moves. After we
+// write our move, a background process searches the position after our move
+// and the reply we expect, then saves the table to the hash file. The next
+// run stops that process, waits for the save, and starts with its table -
+// deep entries for the actual position if we guessed the reply right, and a
+// warm table either way.
+
+// Stop a background ponder left by the previous move (if any), wait briefly
+// for it to save, then load the hash file. Returns true if a table was loaded.
+bool resume_from_hash_file(const std::string& hash_path);
+
+// Ponder AFTER_REPLY (the position after our move and the expected reply,
+// or after our move only if we have no prediction; its positions must already
+// be on the repetition history) in a background process, then save the table
+// to the hash file. Where background processes aren't available, just saves
+// the current table.
+void ponder_in_background(const Board& after_reply, const std::string& hash_path);
+
+#endif // PONDER_H
@@ -0,0 +1,41 @@
+#ifndef TIME_MANAGER_H
+#define TIME_MANAGER_H
+
+#include "board.h"
+#include <cstdint>
+
+// Clock situation for the move about to be searched, in milliseconds.
+// 0 means "not given". With no clock, move_time_ms is spent per move.
+struct TimeControl {
+    int clock_ms = 0;       // time left on our clock
+    int increment_ms = 0;   // added to our clock after every move
+    int moves_to_go = 0;    // moves until the next time control (0 = sudden death)
+    int move_time_ms = 0;   // fixed budget per move, used when clock_ms is 0
+    bool fixed_move_time = false;  // spend all of move_time_ms: no soft limit (UCI "movetime")
+    std::uint64_t max_nodes = 0;  // node budget for the search (0 = none)
+};
+
+// How long to think about one move.
+// soft_ms: target time; no new iteration is started once it is used up.
+//          The search scales it by time_scale() as iterations complete.
+// hard_ms: the search is aborted when this is reached, whatever happens.
+// max_nodes: the search is aborted after this many nodes (0 = no limit).
+struct TimeBudget {
+    int soft_ms = 0;
+    int hard_ms = 0;
+    std::uint64_t max_nodes = 0;
+};
+
+// Split the remaining clock into a soft and hard limit for this move
+TimeBudget allocate_time(const TimeControl& tc);
+
+// Multiplier for the soft limit: below 1 when the best move has stayed the
+// same for several iterations, above 1 after the score dropped (fail low)
+double time_scale(int best_move_stability, bool failed_low);
+
+// Time-managed search: iterative deepening that stops on the soft limit
+// (scaled by stability and fail-lows), aborts on the hard limit and plays a
+// forced reply without searching
+move find_best_move(const Board& board, int max_depth, const TimeControl& tc);
+
+#endif // TIME_MANAGER_H
@@ -0,0 +1,27 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include "move.h"
+#include <chrono>
+#include <string>
+
+// Deadline watchdog for the move file.
+//
+// A background thread sleeps until the deadline. If the engine hasn't
+// finished by then (stop_move_watchdog() not called), it writes the latest
+// published move to the move file and ends the process, so a move is always
+// there in time even if the search is slow to unwind.
+
+// Start the watchdog. FALLBACK is written if no better move gets published.
+// With ANYTIME set, every published move is also written to the file at once.
+void start_move_watchdog(const std::string& move_path,
+                         std::chrono::steady_clock::time_point deadline,
+                         const move& fallback, bool anytime);
+
+// Record a new best move (e.g. after a completed search iteration)
+void publish_best_move(const move& m);
+
+// The engine is about to write its final move: disarm and join the watchdog
+void stop_move_watchdog();
+
+#endif // WATCHDOG_H
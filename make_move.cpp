@@ -35,8 +35,11 @@ void make_move(Board& board, const move& m, Undo& undo) {
     undo.en_passant_row = board.en_passant_row;  // Save en passant state
     undo.en_passant_col = board.en_passant_col;
     undo.was_en_passant = false;
+    undo.halfmove_clock = board.halfmove_clock;
+    undo.fullmove_number = board.fullmove_number;
 
     undo.zobrist_hash = board.zobrist_hash;
+    undo.material_key = board.material_key;
 
     if (board.en_passant_col != -1) {
         // Clear the en passant hash if it was set
@@ -103,6 +106,22 @@ void make_move(Board& board, const move& m, Undo& undo) {
     undo.moved_piece_type = piece.type;
     undo.captured = captured;
 
+    // Material signature: count the captured piece out and the promoted piece in
+    if (captured.type != PieceType::None) {
+        board.material_key -= material_key_unit(captured.color, captured.type);
+    }
+    if (final_type != piece.type) {
+        board.material_key -= material_key_unit(piece.color, piece.type);
+        board.material_key += material_key_unit(piece.color, final_type);
+    }
+
+    // 50-move rule: pawn moves and captures are irreversible and reset the clock
+    if (piece.type == PieceType::Pawn || captured.type != PieceType::None) {
+        board.halfmove_clock = 0;
+    } else {
+        ++board.halfmove_clock;
+    }
+
     // if rook is captured, then opponent castling rights might be lost
     if (!undo.was_en_passant && captured.type == PieceType::Rook)
     {
@@ -203,7 +222,8 @@ void make_move(Board& board, const move& m, Undo& undo) {
 
     board.zobrist_hash ^= Z_CASTLING[castle_index(board)];
 
-    // Switch side to move
+    // Switch side to move; a new move number starts after Black's move
+    if (board.side_to_move == Color::Black) ++board.fullmove_number;
     board.side_to_move = (board.side_to_move == Color::White) ? Color::Black : Color::White;
     board.zobrist_hash ^= Z_SIDE;
 }
@@ -221,6 +241,8 @@ void unmake_move(Board& board, const move& m, const Undo& undo)
     board.side_to_move = undo.side_to_move;
     board.en_passant_row = undo.en_passant_row;
     board.en_passant_col = undo.en_passant_col;  // Restore en passant state
+    board.halfmove_clock = undo.halfmove_clock;
+    board.fullmove_number = undo.fullmove_number;
 
     board.white_can_castle_kingside = undo.white_can_castle_kingside;
     board.white_can_castle_queenside = undo.white_can_castle_queenside;
@@ -272,4 +294,39 @@ void unmake_move(Board& board, const move& m, const Undo& undo)
     }
 
     board.zobrist_hash = undo.zobrist_hash;
+    board.material_key = undo.material_key;
+}
+
+// Null move: the side to move passes. Only the side to move and the en passant
+// square change, so the hash is updated incrementally (side key, and the en
+// passant key if one was set) instead of copying the board. The halfmove clock
+// is reset: positions before a pass can't be repeated after it, and the clock
+// bounds how far back the search looks for repetitions.
+void make_null_move(Board& board, Undo& undo)
+{
+    undo.side_to_move = board.side_to_move;
+    undo.en_passant_row = board.en_passant_row;
+    undo.en_passant_col = board.en_passant_col;
+    undo.halfmove_clock = board.halfmove_clock;
+    undo.zobrist_hash = board.zobrist_hash;
+
+    if (board.en_passant_col != -1) {
+        board.zobrist_hash ^= Z_ENPASSANT[board.en_passant_col];
+    }
+    board.en_passant_row = -1;
+    board.en_passant_col = -1;
+
+    board.halfmove_clock = 0;
+
+    board.side_to_move = (board.side_to_move == Color::White) ? Color::Black : Color::White;
+    board.zobrist_hash ^= Z_SIDE;
+}
+
+void unmake_null_move(Board& board, const Undo& undo)
+{
+    board.side_to_move = undo.side_to_move;
+    board.en_passant_row = undo.en_passant_row;
+    board.en_passant_col = undo.en_passant_col;
+    board.halfmove_clock = undo.halfmove_clock;
+    board.zobrist_hash = undo.zobrist_hash;
 }
@@ -0,0 +1,359 @@
+#include "perft.h"
+#include "fen.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// from 5_generate_output.cpp
+std::string move_to_uci(move m);
+
+// ============================================================================
+// PERFT TABLE
+// ============================================================================
+// Direct-mapped like the transposition table. The slot index mixes in the
+// depth, so the counts of one position at different depths don't evict each
+// other. Always-replace: perft revisits recent subtrees the most.
+// Relaxed atomics are enough: the XOR check rejects mixed entries, and a
+// miss only costs a recount.
+// ============================================================================
+
+PerftTable::PerftTable(std::size_t mb)
+{
+    std::size_t n = mb * 1024ULL * 1024ULL / sizeof(Entry);
+    std::size_t pow2 = 1;
+    while (pow2 * 2 <= n) pow2 <<= 1;
+    table.reset(new Entry[pow2]);
+    mask = pow2 - 1;
+}
+
+namespace {
+
+std::size_t perft_slot(std::uint64_t key, int depth, std::size_t mask)
+{
+    return (key ^ (static_cast<std::uint64_t>(depth) * 0x9e3779b97f4a7c15ULL)) & mask;
+}
+
+} // namespace
+
+bool PerftTable::probe(std::uint64_t key, int depth, std::uint64_t& nodes) const
+{
+    const Entry& e = table[perft_slot(key, depth, mask)];
+    const std::uint64_t data = e.data.load(std::memory_order_relaxed);
+    const std::uint64_t check = e.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key || static_cast<int>(data & 0xFF) != depth) return false;
+    nodes = data >> 8;
+    return true;
+}
+
+void PerftTable::store(std::uint64_t key, int depth, std::uint64_t nodes)
+{
+    Entry& e = table[perft_slot(key, depth, mask)];
+    const std::uint64_t data = nodes << 8 | static_cast<std::uint64_t>(depth & 0xFF);
+    e.check.store(key ^ data, std::memory_order_relaxed);
+    e.data.store(data, std::memory_order_relaxed);
+}
+
+// ============================================================================
+// PERFT
+// ============================================================================
+
+namespace {
+
+// One move buffer per remaining depth, reused across calls (no allocation
+// inside the tree walk)
+std::uint64_t perft_recursive(Board& board, int depth, PerftTable* table,
+                              std::vector<std::vector<move>>& buffers)
+{
+    std::uint64_t cached = 0;
+    if (depth > 1 && table != nullptr && table->probe(board.zobrist_hash, depth, cached)) {
+        return cached;
+    }
+
+    std::vector<move>& moves = buffers[depth];
+    generate_legal_moves(board, moves);
+    if (depth == 1) return moves.size();  // bulk counting
+
+    std::uint64_t nodes = 0;
+    Undo undo;
+    for (const move& m : moves) {
+        make_move(board, m, undo);
+        nodes += perft_recursive(board, depth - 1, table, buffers);
+        unmake_move(board, m, undo);
+    }
+
+    if (table != nullptr) {
+        table->store(board.zobrist_hash, depth, nodes);
+    }
+    return nodes;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+long long nodes_per_second(std::uint64_t nodes, double seconds)
+{
+    return seconds > 0 ? static_cast<long long>(nodes / seconds) : 0;
+}
+
+} // namespace
+
+std::uint64_t perft(Board& board, int depth, PerftTable* table)
+{
+    if (depth <= 0) return 1;
+    std::vector<std::vector<move>> buffers(depth + 1);
+    return perft_recursive(board, depth, table, buffers);
+}
+
+// ============================================================================
+// PARALLEL PERFT
+// ============================================================================
+// The work is cut into one task per two-ply line (one per root move at depth
+// 2), which gives a few hundred to a few thousand tasks of uneven size.
+// Tasks are dealt round-robin into one queue per thread. A thread takes from
+// the front of its own queue and, once that is empty, steals from the back
+// of the others', so threads that drew cheap lines help with the expensive
+// ones. No tasks are created after the start, so a thread that finds every
+// queue empty is done.
+// ============================================================================
+
+namespace {
+
+struct PerftTask {
+    Board board;             // position after the task's first one or two moves
+    int depth = 0;           // plies left to count from there
+    std::size_t root = 0;    // index of the root move the task belongs to
+    std::uint64_t nodes = 0; // result, written only by the thread that ran it
+};
+
+struct PerftQueue {
+    std::mutex mutex;
+    std::deque<std::size_t> tasks;  // indexes into the task list
+};
+
+bool take_task(std::vector<PerftQueue>& queues, std::size_t self, std::size_t& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(queues[self].mutex);
+        if (!queues[self].tasks.empty()) {
+            task = queues[self].tasks.front();
+            queues[self].tasks.pop_front();
+            return true;
+        }
+    }
+    for (std::size_t i = 1; i < queues.size(); ++i) {
+        PerftQueue& victim = queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void run_perft_worker(std::vector<PerftTask>& tasks, std::vector<PerftQueue>& queues,
+                      std::size_t self, PerftTable* table)
+{
+    std::vector<std::vector<move>> buffers;
+    std::size_t index = 0;
+    while (take_task(queues, self, index)) {
+        PerftTask& task = tasks[index];
+        if (task.depth <= 0) {
+            task.nodes = 1;
+            continue;
+        }
+        if (buffers.size() < static_cast<std::size_t>(task.depth + 1)) {
+            buffers.resize(task.depth + 1);
+        }
+        task.nodes = perft_recursive(task.board, task.depth, table, buffers);
+    }
+}
+
+int resolve_threads(int threads)
+{
+    if (threads > 0) return threads;
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+} // namespace
+
+std::uint64_t parallel_perft(const Board& board, int depth, int threads, PerftTable* table,
+                             std::vector<std::uint64_t>* root_counts)
+{
+    Board root = board;
+    const std::vector<move> root_moves = generate_legal_moves(root);
+    if (root_counts != nullptr) root_counts->assign(root_moves.size(), 0);
+    if (depth <= 0) return 1;
+    if (depth == 1) {
+        if (root_counts != nullptr) root_counts->assign(root_moves.size(), 1);
+        return root_moves.size();
+    }
+
+    // One task per root move at depth 2, else one per two-ply line
+    std::vector<PerftTask> tasks;
+    Undo undo;
+    for (std::size_t i = 0; i < root_moves.size(); ++i) {
+        make_move(root, root_moves[i], undo);
+        if (depth == 2) {
+            tasks.push_back({root, 1, i, 0});
+        } else {
+            Board after = root;
+            Undo reply_undo;
+            for (const move& reply : generate_legal_moves(after)) {
+                make_move(after, reply, reply_undo);
+                tasks.push_back({after, depth - 2, i, 0});
+                unmake_move(after, reply, reply_undo);
+            }
+        }
+        unmake_move(root, root_moves[i], undo);
+    }
+
+    const std::size_t thread_count = std::min<std::size_t>(resolve_threads(threads), std::max<std::size_t>(1, tasks.size()));
+    std::vector<PerftQueue> queues(thread_count);
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        queues[i % thread_count].tasks.push_back(i);
+    }
+
+    // The calling thread is worker 0
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < thread_count; ++t) {
+        workers.emplace_back(run_perft_worker, std::ref(tasks), std::ref(queues), t, table);
+    }
+    run_perft_worker(tasks, queues, 0, table);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    std::uint64_t total = 0;
+    for (const PerftTask& task : tasks) {
+        total += task.nodes;
+        if (root_counts != nullptr) (*root_counts)[task.root] += task.nodes;
+    }
+    return total;
+}
+
+std::uint64_t perft_divide(const Board& board, int depth, int threads, PerftTable* table)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::uint64_t> root_counts;
+    const std::uint64_t total = parallel_perft(board, depth, threads, table, &root_counts);
+    const double seconds = seconds_since(start);
+
+    if (depth > 0) {
+        const std::vector<move> root_moves = generate_legal_moves(board);
+        for (std::size_t i = 0; i < root_moves.size(); ++i) {
+            std::cout << move_to_uci(root_moves[i]) << ": " << root_counts[i] << '\n';
+        }
+        std::cout << "\nMoves: " << root_moves.size() << '\n';
+    }
+
+    std::cout << "Nodes: " << total << '\n'
+              << "Threads: " << resolve_threads(threads) << '\n'
+              << "Time: " << static_cast<long long>(seconds * 1000) << " ms\n"
+              << "NPS: " << nodes_per_second(total, seconds) << '\n';
+    return total;
+}
+
+void perft_scaling(const Board& board, int depth, int max_threads, std::size_t hash_mb)
+{
+    max_threads = resolve_threads(max_threads);
+    double single_seconds = 0;
+    for (int threads = 1; ; threads = std::min(threads * 2, max_threads)) {
+        std::unique_ptr<PerftTable> table;
+        if (hash_mb > 0) table.reset(new PerftTable(hash_mb));
+
+        const auto start = std::chrono::steady_clock::now();
+        const std::uint64_t nodes = parallel_perft(board, depth, threads, table.get());
+        const double seconds = seconds_since(start);
+        if (threads == 1) single_seconds = seconds;
+
+        const double speedup = seconds > 0 ? single_seconds / seconds : 0;
+        std::cout << "threads " << threads << ": " << nodes << " nodes | "
+                  << static_cast<long long>(seconds * 1000) << " ms | NPS "
+                  << nodes_per_second(nodes, seconds) << " | speed-up " << speedup
+                  << " | efficiency " << static_cast<int>(100 * speedup / threads) << "%\n";
+
+        if (threads == max_threads) break;
+    }
+}
+
+// ============================================================================
+// PERFT SUITE - positions with published node counts
+// ============================================================================
+
+namespace {
+
+struct PerftPosition {
+    const char* name;
+    const char* fen;
+    std::vector<std::uint64_t> counts;  // counts[d - 1] = perft(d)
+};
+
+const std::vector<PerftPosition>& perft_positions()
+{
+    static const std::vector<PerftPosition> positions = {
+        {"startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+         {20, 400, 8902, 197281, 4865609, 119060324}},
+        {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+         {48, 2039, 97862, 4085603, 193690690}},
+        {"endgame", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+         {14, 191, 2812, 43238, 674624, 11030083, 178633661}},
+        {"promotions", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+         {6, 264, 9467, 422333, 15833292}},
+        {"talkchess", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+         {44, 1486, 62379, 2103487, 89941194}},
+        {"middlegame", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+         {46, 2079, 89890, 3894594, 164075551}},
+    };
+    return positions;
+}
+
+} // namespace
+
+bool run_perft_suite(int max_depth, int threads, std::size_t hash_mb)
+{
+    std::unique_ptr<PerftTable> table;
+    if (hash_mb > 0) table.reset(new PerftTable(hash_mb));
+
+    const auto start = std::chrono::steady_clock::now();
+    std::uint64_t total_nodes = 0;
+    bool all_ok = true;
+
+    for (const PerftPosition& position : perft_positions()) {
+        Board board;
+        if (!board_from_fen(position.fen, board)) {
+            std::cout << position.name << ": invalid FEN\n";
+            all_ok = false;
+            continue;
+        }
+
+        const int depth = std::max(1, std::min<int>(max_depth, static_cast<int>(position.counts.size())));
+        const auto position_start = std::chrono::steady_clock::now();
+        const std::uint64_t nodes = parallel_perft(board, depth, threads, table.get());
+        const double seconds = seconds_since(position_start);
+        const std::uint64_t expected = position.counts[depth - 1];
+        const bool ok = nodes == expected;
+        all_ok = all_ok && ok;
+        total_nodes += nodes;
+
+        std::cout << position.name << " depth " << depth << ": " << nodes
+                  << (ok ? " ok" : " FAIL (expected " + std::to_string(expected) + ")")
+                  << " | " << static_cast<long long>(seconds * 1000) << " ms"
+                  << " | NPS " << nodes_per_second(nodes, seconds) << '\n';
+    }
+
+    const double seconds = seconds_since(start);
+    std::cout << "Total: " << total_nodes << " nodes in " << static_cast<long long>(seconds * 1000)
+              << " ms | NPS " << nodes_per_second(total_nodes, seconds)
+              << (all_ok ? " | all counts correct" : " | COUNT MISMATCH") << '\n';
+    return all_ok;
+}
@@ -0,0 +1,196 @@
+#include "ponder.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#define CHESS_KING_CAN_FORK 1
+#endif
+
+// from 4_select_best_move.cpp
+extern bool save_transposition_table(const std::string& path);
+extern bool load_transposition_table(const std::string& path);
+
+// ============================================================================
+// BACKGROUND PONDERING - Hand-over between the ponder process and the next run
+// ============================================================================
+// Two marker files next to the hash file coordinate the processes:
+//   <hash>.lock  exists while a ponder process runs and holds its pid (it
+//                removes it when done; a lock whose process is gone is stale).
+//                It is created holding the parent's pid before the fork, and
+//                the child's pid replaces it; both are written to a temporary
+//                file and renamed, so the lock never holds a partial pid
+//   <hash>.stop  created by the next run to ask the ponder process to finish
+// The ponder process watches for the stop file, stops its search, saves the
+// table (atomically, via rename) and removes both files. Should it never see
+// a stop request, it gives up after PONDER_MAX_MS so nothing lingers. One
+// that misses the hand-over deadline is killed before its save can land.
+// ============================================================================
+
+namespace {
+constexpr int PONDER_MAX_MS = 120000;      // Longest a ponder process may run
+constexpr int PONDER_MAX_DEPTH = 64;
+constexpr int HANDOFF_WAIT_MS = 1500;      // How long the next run waits for the save
+constexpr int STOP_POLL_MS = 2;            // How often the ponder process checks for the stop file
+
+bool file_exists(const std::string& path) {
+    std::ifstream f(path);
+    return f.good();
+}
+
+void touch(const std::string& path) {
+    std::ofstream f(path);
+}
+
+#ifdef CHESS_KING_CAN_FORK
+// The lock file holds the pid of the ponder process; 0 if unreadable
+pid_t read_lock_pid(const std::string& lock_path) {
+    std::ifstream f(lock_path);
+    long pid = 0;
+    if (!(f >> pid) || pid <= 0) return 0;
+    return static_cast<pid_t>(pid);
+}
+
+bool process_alive(pid_t pid) {
+    return pid > 0 && kill(pid, 0) == 0;
+}
+
+// A lock is stale when the process it names is gone. No pid (a lock from an
+// older build) counts as live. The parent hands the lock to the child before
+// it exits, so a dead pid is only final if the lock still names it afterwards
+bool lock_is_stale(const std::string& lock_path) {
+    const pid_t pid = read_lock_pid(lock_path);
+    if (pid == 0 || process_alive(pid)) return false;
+    return read_lock_pid(lock_path) == pid;
+}
+
+bool write_lock_pid(const std::string& lock_path, pid_t pid) {
+    const std::string tmp_path = lock_path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        out << pid << '\n';
+        if (!out) return false;
+    }
+    return std::rename(tmp_path.c_str(), lock_path.c_str()) == 0;
+}
+#endif
+
+} // anonymous namespace
+
+bool resume_from_hash_file(const std::string& hash_path) {
+    const std::string lock_path = hash_path + ".lock";
+    const std::string stop_path = hash_path + ".stop";
+
+#ifdef CHESS_KING_CAN_FORK
+    if (file_exists(lock_path) && lock_is_stale(lock_path)) {
+        // Left behind by a ponder process that crashed: nobody to wait for
+        std::cerr << "Ponder: removing stale lock " << lock_path << "\n";
+        std::remove(lock_path.c_str());
+    }
+#endif
+
+    if (file_exists(lock_path)) {
+        touch(stop_path);
+        auto start = std::chrono::steady_clock::now();
+        while (file_exists(lock_path)) {
+#ifdef CHESS_KING_CAN_FORK
+            // A child that stopped before the parent handed it the lock
+            // leaves its own pid behind when it exits
+            if (lock_is_stale(lock_path)) {
+                std::remove(lock_path.c_str());
+                break;
+            }
+#endif
+            auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            if (waited >= HANDOFF_WAIT_MS) {
+                std::cerr << "Ponder: background search did not finish in time, using the last saved table\n";
+#ifdef CHESS_KING_CAN_FORK
+                // It must not save over the table of the next ponder process
+                const pid_t pid = read_lock_pid(lock_path);
+                if (process_alive(pid)) kill(pid, SIGKILL);
+                std::remove(lock_path.c_str());
+#endif
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(STOP_POLL_MS));
+        }
+        std::remove(stop_path.c_str());
+    }
+
+    if (!load_transposition_table(hash_path)) {
+        std::cerr << "Ponder: no usable hash file at " << hash_path << ", starting cold\n";
+        return false;
+    }
+    std::cerr << "Ponder: loaded hash file " << hash_path << "\n";
+    return true;
+}
+
+void ponder_in_background(const Board& after_reply, const std::string& hash_path) {
+#ifdef CHESS_KING_CAN_FORK
+    const std::string lock_path = hash_path + ".lock";
+    const std::string stop_path = hash_path + ".stop";
+
+    // Anything still buffered would otherwise be written twice
+    std::cout.flush();
+    std::cerr.flush();
+
+    // The move file is already written, so the next run may start any moment:
+    // the lock must exist, with a live pid in it, from before the fork on
+    std::remove(stop_path.c_str());
+    if (!write_lock_pid(lock_path, getpid())) {
+        save_transposition_table(hash_path);
+        return;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        std::remove(lock_path.c_str());
+        save_transposition_table(hash_path);
+        return;
+    }
+    if (pid > 0) {
+        // Parent: hand the lock to the child, then exit as usual
+        write_lock_pid(lock_path, pid);
+        return;
+    }
+
+    // Child: leave the parent's session and pipes, so whoever reads the
+    // engine's output sees end of file as soon as the parent exits
+    setsid();
+    int null_fd = open("/dev/null", O_RDWR);
+    if (null_fd >= 0) {
+        dup2(null_fd, 0);
+        dup2(null_fd, 1);
+        dup2(null_fd, 2);
+        if (null_fd > 2) close(null_fd);
+    }
+
+    // Ponder until the next run asks us to stop (or PONDER_MAX_MS)
+    reset_search_stop();
+    std::thread stop_watcher([stop_path] {
+        while (!file_exists(stop_path)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(STOP_POLL_MS));
+        }
+        request_search_stop();
+    });
+    stop_watcher.detach();
+
+    find_best_move(after_reply, PONDER_MAX_DEPTH, PONDER_MAX_MS);
+    save_transposition_table(hash_path);
+    // Only our own lock: after a timed-out hand-over it may be the next ponder's
+    if (read_lock_pid(lock_path) == getpid()) {
+        std::remove(lock_path.c_str());
+    }
+    std::_Exit(0);
+#else
+    (void)after_reply;
+    save_transposition_table(hash_path);
+#endif
+}
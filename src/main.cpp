@@ -1,14 +1,46 @@
 #include "board.h"
 #include "move.h"
 #include "openings.h"
+#include "time_manager.h"
+#include "watchdog.h"
+#include "ponder.h"
+#include "fen.h"
+#include "perft.h"
+#include "bench.h"
 #include "../zobrist_h.h"
 
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
+#include <algorithm>
 #include <cctype>
+#include <cerrno>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <map>
+#include <memory>
+#include <set>
+#include <type_traits>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+#ifdef __unix__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
 
 // forward declarations for functions in other files
 extern Board make_starting_position();
@@ -22,6 +54,13 @@ extern move find_best_move(const Board& board, int max_depth, int time_limit_ms)
 extern void add_position_to_history(std::uint64_t hash);
 extern void clear_position_history();
 extern size_t get_position_history_size();
+extern std::vector<std::uint64_t> get_position_history();
+extern void set_position_history(const std::vector<std::uint64_t>& hashes);
+
+// Transposition table and statistics, also from 4_select_best_move.cpp
+extern void clear_transposition_table();
+extern void resize_transposition_table(std::size_t mb);
+extern std::uint64_t get_search_node_count();
 
 // from 5_generate_output.cpp
 std::string move_to_uci(move m);
@@ -31,18 +70,58 @@ namespace {
     // print usage message for incorrect arguments
     void print_usage(const char* program_name) {
         std::cerr << "Usage: " << program_name
-                << " -H <path to input history file> -m <path to output move file>\n";
+                << " -H <path to input history file> -m <path to output move file>"
+                << " [-F <fen>] [-t <clock ms> -i <increment ms> -g <moves to go>]"
+                << " [-d <deadline ms>] [-a] [-p <hash file>] [-D]\n"
+                << "       " << program_name
+                << " -S <socket path> [-w <workers>] [-t <clock ms> -i <increment ms> -g <moves to go>]\n"
+                << "       " << program_name
+                << " -P <depth | suite [depth]> [-F <fen>] [-c <perft hash MB>] [-w <threads>] [-e]\n"
+                << "       " << program_name << " -B <depth> [-w <threads> -e]\n";
     }
 
+    // Fixed think time per move when no clock is given
+    constexpr int DEFAULT_MOVE_TIME_MS = 9300;
+    // Time from start-up after which the watchdog writes whatever move we have
+    constexpr int DEFAULT_DEADLINE_MS = 9800;
+    // Default depth of the perft suite: 10.7 million nodes in all (startpos
+    // 197281 and endgame 43238, the others 422333 to 4085603)
+    constexpr int PERFT_SUITE_DEPTH = 4;
+
     // struct to hold CLI options
     struct ProgramOptions {
         std::string history_path;
         std::string move_path;
+        std::string fen;        // start position; the history holds the moves played from it
+        TimeControl time_control;
+        int deadline_ms = DEFAULT_DEADLINE_MS;
+        bool anytime = false;  // rewrite the move file after every completed depth
+        std::string hash_path;  // persistent hash file; enables pondering between runs
+        bool daemon = false;    // stay resident and answer each change of the history file
+        std::string socket_path;  // serve many games over this Unix socket
+        int workers = 0;          // server search / perft threads; 0 = one per core
+        int perft_depth = -1;     // count the move tree of -F (or the start) to this depth
+        bool perft_suite = false; // run the built-in perft positions instead
+        int perft_suite_depth = PERFT_SUITE_DEPTH;  // ...to this depth (each stops at its deepest known count)
+        int perft_hash_mb = 0;    // perft subtree cache; 0 = off
+        bool perft_scaling = false;  // time the perft (or bench) at 1, 2, 4, ... threads up to -w
+        int bench_depth = 0;      // search the bench positions to this depth; 0 = no bench
     };
 
+    // parse a non-negative integer option value
+    bool parse_int(const char* text, int& value) {
+        try {
+            size_t used = 0;
+            value = std::stoi(text, &used);
+            return used == std::string(text).size() && value >= 0;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
     // parse -H and -m command line arguments
     bool parse_arguments(int argc, char* argv[], ProgramOptions& options) {
-        if (argc < 5) {
+        if (argc < 3) {
             print_usage(argv[0]);
             return false;
         }
@@ -53,13 +132,50 @@ namespace {
                 options.history_path = argv[++i];
             } else if (arg == "-m" && i + 1 < argc) {
                 options.move_path = argv[++i];
+            } else if (arg == "-F" && i + 1 < argc) {
+                options.fen = argv[++i];
+            } else if (arg == "-t" && i + 1 < argc && parse_int(argv[i + 1], options.time_control.clock_ms)) {
+                ++i;
+            } else if (arg == "-i" && i + 1 < argc && parse_int(argv[i + 1], options.time_control.increment_ms)) {
+                ++i;
+            } else if (arg == "-g" && i + 1 < argc && parse_int(argv[i + 1], options.time_control.moves_to_go)) {
+                ++i;
+            } else if (arg == "-d" && i + 1 < argc && parse_int(argv[i + 1], options.deadline_ms)) {
+                ++i;
+            } else if (arg == "-a") {
+                options.anytime = true;
+            } else if (arg == "-p" && i + 1 < argc) {
+                options.hash_path = argv[++i];
+            } else if (arg == "-D") {
+                options.daemon = true;
+            } else if (arg == "-S" && i + 1 < argc) {
+                options.socket_path = argv[++i];
+            } else if (arg == "-w" && i + 1 < argc && parse_int(argv[i + 1], options.workers)) {
+                ++i;
+            } else if (arg == "-P" && i + 1 < argc && std::string(argv[i + 1]) == "suite") {
+                options.perft_suite = true;
+                ++i;
+                // Optional depth right after "suite"
+                if (i + 1 < argc && parse_int(argv[i + 1], options.perft_suite_depth)) ++i;
+            } else if (arg == "-P" && i + 1 < argc && parse_int(argv[i + 1], options.perft_depth)) {
+                ++i;
+            } else if (arg == "-c" && i + 1 < argc && parse_int(argv[i + 1], options.perft_hash_mb)) {
+                ++i;
+            } else if (arg == "-B" && i + 1 < argc && parse_int(argv[i + 1], options.bench_depth)) {
+                ++i;
+            } else if (arg == "-e") {
+                options.perft_scaling = true;
             } else {
                 print_usage(argv[0]);
                 return false;
             }
         }
 
-        if (options.history_path.empty() || options.move_path.empty()) {
+        // The server gets its games over the socket; every other mode needs both
+        // files, except that a single move from -F needs no history
+        bool has_position = !options.history_path.empty() || (!options.fen.empty() && !options.daemon);
+        bool standalone = options.perft_suite || options.perft_depth >= 0 || options.bench_depth > 0;
+        if (!standalone && options.socket_path.empty() && (!has_position || options.move_path.empty())) {
             print_usage(argv[0]);
             return false;
         }
@@ -85,12 +201,37 @@ namespace {
                 case 'r': promotion = ROOK; break;
                 case 'b': promotion = BISHOP; break;
                 case 'k': promotion = KNIGHT; break;
+                case 'n': promotion = KNIGHT; break;  // standard UCI letter
             }
         }
         
         return move(from_row, from_col, to_row, to_col, promotion);
     }
 
+    // Read the moves of a history file, one per line, whitespace trimmed and
+    // blank lines skipped. Returns false if the file can't be opened.
+    bool read_history_lines(const std::string& history_path, std::vector<std::string>& lines) {
+        std::ifstream history_file(history_path);
+        if (!history_file.is_open()) {
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(history_file, line)) {
+            // Trim whitespace (including \r)
+            while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back()))) {
+                line.pop_back();
+            }
+            while (!line.empty() && std::isspace(static_cast<unsigned char>(line.front()))) {
+                line.erase(0, 1);
+            }
+            if (!line.empty()) {
+                lines.push_back(line);
+            }
+        }
+        return true;
+    }
+
     // Print the board state for debugging/verification
     // Displays the chess board in a readable format with piece positions,
     // current side to move, and castling rights
@@ -118,76 +259,965 @@ namespace {
         std::cout << "Castling: W-K=" << board.white_can_castle_kingside 
                   << " W-Q=" << board.white_can_castle_queenside
                   << " B-K=" << board.black_can_castle_kingside
-                  << " B-Q=" << board.black_can_castle_queenside << "\n\n";
+                  << " B-Q=" << board.black_can_castle_queenside << "\n";
+        std::cout << "FEN: " << board_to_fen(board) << "\n\n";
+    }
+
+    // =====================================================================
+    // HISTORY REPLAY CACHE
+    // =====================================================================
+    // A per-move run would otherwise replay the whole game from the starting
+    // position. After each replay we leave a snapshot next to the history
+    // file (<history>.cache): how many moves were replayed, a hash of their
+    // text, the Board after them and the repetition keys. The next run checks
+    // that those moves are still a prefix of the history and replays only the
+    // moves appended since. Any mismatch (another game, an older engine build,
+    // a damaged file) simply means a full replay. The header carries a format
+    // version and a Zobrist fingerprint, so a build that lays out or hashes
+    // the Board differently never picks up a snapshot of another one.
+    // =====================================================================
+
+    constexpr std::uint64_t HISTORY_CACHE_MAGIC = 0x31545348474E494BULL;  // "KINGHST1"
+    constexpr std::uint64_t HISTORY_CACHE_VERSION = 2;  // bump when Board's meaning changes
+    static_assert(std::is_trivially_copyable<Board>::value, "the cache stores Board as raw bytes");
+
+    struct HistorySnapshot {
+        Board board;
+        std::size_t moves = 0;                // history lines replayed into board
+        std::vector<std::uint64_t> hashes;    // repetition keys, starting position first
+    };
+
+    std::string history_cache_path(const std::string& history_path) {
+        return history_path + ".cache";
+    }
+
+    // FNV-1a over the start position's hash and the first COUNT lines, each
+    // terminated by a newline
+    std::uint64_t hash_history_prefix(std::uint64_t start_hash, const std::vector<std::string>& lines,
+                                      std::size_t count) {
+        std::uint64_t h = 0xcbf29ce484222325ULL ^ start_hash;
+        for (std::size_t i = 0; i < count; ++i) {
+            for (unsigned char c : lines[i]) {
+                h = (h ^ c) * 0x100000001b3ULL;
+            }
+            h = (h ^ '\n') * 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    // Load the snapshot if its moves are a prefix of LINES
+    bool load_history_cache(const std::string& path, std::uint64_t start_hash,
+                            const std::vector<std::string>& lines, HistorySnapshot& snapshot) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+
+        // magic, version, sizeof(Board), Zobrist fingerprint, moves, prefix hash, hash count
+        std::uint64_t header[7] = {};
+        in.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (!in || header[0] != HISTORY_CACHE_MAGIC || header[1] != HISTORY_CACHE_VERSION ||
+            header[2] != sizeof(Board) || header[3] != Z_SIDE ||
+            header[4] > lines.size() || header[5] != hash_history_prefix(start_hash, lines, header[4]) ||
+            header[6] != header[4] + 1) {
+            return false;
+        }
+
+        snapshot.moves = header[4];
+        snapshot.hashes.resize(header[6]);
+        in.read(reinterpret_cast<char*>(&snapshot.board), sizeof(Board));
+        in.read(reinterpret_cast<char*>(snapshot.hashes.data()), snapshot.hashes.size() * sizeof(std::uint64_t));
+        return static_cast<bool>(in);
+    }
+
+    // Written to a temporary file and renamed, so a reader never sees half a snapshot
+    bool save_history_cache(const std::string& path, std::uint64_t start_hash,
+                            const std::vector<std::string>& lines, const HistorySnapshot& snapshot) {
+        const std::string tmp_path = path + ".tmp";
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        const std::uint64_t header[7] = {HISTORY_CACHE_MAGIC, HISTORY_CACHE_VERSION, sizeof(Board), Z_SIDE,
+                                         snapshot.moves, hash_history_prefix(start_hash, lines, snapshot.moves),
+                                         snapshot.hashes.size()};
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(&snapshot.board), sizeof(Board));
+        out.write(reinterpret_cast<const char*>(snapshot.hashes.data()), snapshot.hashes.size() * sizeof(std::uint64_t));
+        out.close();
+        if (!out) return false;
+        return std::rename(tmp_path.c_str(), path.c_str()) == 0;
     }
 
     // parse history file and reconstruct board state
     // ALSO tracks all positions in history for threefold repetition detection
-    Board parse_history(const std::string& history_path, std::vector<std::string>& move_history) {
-        Board board = make_starting_position();
-        std::ifstream history_file(history_path);
+    // Starts from the replay cache when it covers a prefix of the history
+    // The moves are played from START (the starting position unless -F is given)
+    Board parse_history(const Board& start, const std::string& history_path, std::vector<std::string>& move_history) {
+        HistorySnapshot snapshot;
+        snapshot.board = start;
+        snapshot.hashes.assign(1, snapshot.board.zobrist_hash);
+
+        std::vector<std::string> lines;
+        if (history_path.empty() || !read_history_lines(history_path, lines)) {
+            if (!history_path.empty()) {
+                std::cerr << "Warning: History file not found. Assuming starting position.\n";
+            }
+            set_position_history(snapshot.hashes);
+            return snapshot.board;
+        }
+
+        const std::string cache_path = history_cache_path(history_path);
+        HistorySnapshot cached;
+        if (load_history_cache(cache_path, start.zobrist_hash, lines, cached)) {
+            snapshot = std::move(cached);
+        }
+        const std::size_t from_cache = snapshot.moves;
+
+        move_history = lines;
+        Board& board = snapshot.board;
+        for (std::size_t i = snapshot.moves; i < lines.size(); ++i) {
+            const std::string& line = lines[i];
+            move m = parse_move(line);
+            
+            // VALIDATION: Check that the move is legal before applying
+            // This catches history file corruption or format mismatches
+            // (a single-move check, so replay stays linear in the number of moves)
+            if (!is_legal(board, m)) {
+                std::cerr << "ERROR: Illegal move in history file: '" << line << "'\n";
+                std::cerr << "  Parsed as: (" << m.from_row << "," << m.from_col 
+                          << ")->(" << m.to_row << "," << m.to_col << ")\n";
+                // Continue anyway to see full error output
+            }
+            
+            // Replay the move
+            make_move(board, m);
+            
+            // REPETITION TRACKING: Store position hash after each move
+            // This builds the history of all positions in the game
+            // so we can detect threefold repetition
+            snapshot.hashes.push_back(board.zobrist_hash);
+        }
+        snapshot.moves = lines.size();
+
+        if (snapshot.moves != from_cache && !save_history_cache(cache_path, start.zobrist_hash, lines, snapshot)) {
+            std::cerr << "Warning: could not write history cache " << cache_path << '\n';
+        }
+        set_position_history(snapshot.hashes);
+
+        std::cerr << "Position history: " << get_position_history_size() << " positions tracked ("
+                  << from_cache << " of " << lines.size() << " moves from cache)\n";
         
-        // Clear any previous position history and add starting position
+        return board;
+    }
+
+    // Pick our move for BOARD. LEGAL must not be empty; the result is always one of them.
+    // Iterative deepening: starts at depth 1, increases until time runs out
+    // Check opening book FIRST before searching (keyed by the moves from the
+    // starting position, so USE_BOOK is false for games set up from a FEN).
+    // SPENT_MS is time already gone on this move (start-up, loading tables),
+    // taken off the clock and the move time so the search ends when it should
+    move choose_move(const Board& board, const std::vector<std::string>& move_history,
+                     const std::vector<move>& legal, const TimeControl& time_control, bool& from_book,
+                     bool use_book = true, int spent_ms = 0) {
+        move best_move(0, 0, 0, 0);
+        move book_move = use_book ? get_book_move(move_history) : move(0, 0, 0, 0);
+
+        // Check if book move is valid (not 0,0,0,0)
+        from_book = (book_move.from_row != 0 || book_move.from_col != 0 || 
+                     book_move.to_row != 0 || book_move.to_col != 0);
+
+        if (from_book) {
+            // We have a book move! Use it instantly
+            std::cout << "Playing opening book move!\n";
+            best_move = book_move;
+        } else {
+            // Not in book - search for best move using Negamax with time control
+            // The time manager turns the clock (or the fixed 9.3s per move) into
+            // soft/hard limits and stops early on stable or forced moves
+            constexpr int MAX_SEARCH_DEPTH = 20;  // Maximum depth to search
+            TimeControl tc = time_control;
+            tc.move_time_ms = DEFAULT_MOVE_TIME_MS;
+            if (spent_ms > 0) {
+                tc.move_time_ms = std::max(1, tc.move_time_ms - spent_ms);
+                if (tc.clock_ms > 0) tc.clock_ms = std::max(1, tc.clock_ms - spent_ms);
+            }
+            best_move = find_best_move(board, MAX_SEARCH_DEPTH, tc);
+        }
+
+        // SAFETY CHECK: Validate that best_move is actually in the legal moves list
+        // This prevents writing invalid moves that could cause the engine to lose
+        // This should never happen, but it's a critical safety check
+        if (!is_legal(board, best_move)) {
+            std::cerr << "Warning: Best move " << move_to_uci(best_move) 
+                      << " is not in legal moves list! Using first legal move as fallback.\n";
+            best_move = legal.front();
+        }
+        return best_move;
+    }
+
+    // Search progress goes to the watchdog (and, in anytime mode, straight to the move file)
+    void on_iteration_complete(const move& best_move, int depth, int score) {
+        (void)depth;
+        (void)score;
+        publish_best_move(best_move);
+    }
+
+    // =====================================================================
+    // UCI MODE - a long-lived engine process speaking UCI on stdin/stdout
+    // =====================================================================
+    // Started when the program gets no arguments, which is how GUIs and match
+    // runners launch engines. Unlike per-move mode, the process lives for the
+    // whole game: Zobrist keys are set up once, and the transposition table
+    // and history tables carry over from move to move.
+    //
+    // Searches run on one long-lived worker thread, so the input loop keeps
+    // reading and "stop" reaches the search at its next node-countdown poll
+    // (about 1 ms). The worker owns the thread-local search state (history
+    // tables, search stack), which is why it is not restarted for each "go".
+    // Commands that change engine state (position, go, setoption, ucinewgame)
+    // stop a running search and wait for its bestmove first.
+    //
+    // Pondering: "bestmove" names the reply we expect (from the TT), and the
+    // GUI may then send "go ponder" on the position after it. That search runs
+    // without time limits until "ponderhit" (we guessed right: it carries on
+    // as a normal timed search, time spent so far included) or "stop" (we
+    // guessed wrong: its result is dropped, but the TT stays warm).
+    // =====================================================================
+
+    constexpr int UCI_DEFAULT_HASH_MB = 64;
+    constexpr int UCI_MAX_HASH_MB = 4096;
+    constexpr int UCI_MAX_DEPTH = 64;  // depth limit when "go" doesn't give one
+
+    std::mutex g_uci_output_mutex;  // the worker and the input loop both write to stdout
+    std::chrono::steady_clock::time_point g_uci_search_start;
+
+    void uci_send(const std::string& line) {
+        std::lock_guard<std::mutex> lock(g_uci_output_mutex);
+        std::cout << line << std::endl;
+    }
+
+    // UCI writes knight promotions as 'n'; move files use 'k'
+    std::string uci_move_string(const move& m) {
+        std::string text = move_to_uci(m);
+        if (m.promotion == KNIGHT && !text.empty()) text.back() = 'n';
+        return text;
+    }
+
+    // "cp <n>", or "mate <n>" (in moves, negative when we get mated) for mate
+    // scores, which the search gives as CHECKMATE_SCORE minus the plies to mate
+    std::string uci_score(int score) {
+        constexpr int CHECKMATE_SCORE = 100000;  // as in 3_search_moves.cpp
+        constexpr int MATE_THRESHOLD = 90000;    // as in 4_select_best_move.cpp
+        if (std::abs(score) < MATE_THRESHOLD) {
+            return "cp " + std::to_string(score);
+        }
+        const int plies = CHECKMATE_SCORE - std::abs(score);
+        const int moves = (plies + 1) / 2;
+        return "mate " + std::to_string(score > 0 ? moves : -moves);
+    }
+
+    void on_uci_iteration(const move& best_move, int depth, int score) {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - g_uci_search_start).count();
+        std::uint64_t nodes = get_search_node_count();
+        std::ostringstream info;
+        info << "info depth " << depth << " score " << uci_score(score)
+             << " nodes " << nodes << " time " << ms
+             << " nps " << (ms > 0 ? nodes * 1000 / ms : nodes)
+             << " pv " << uci_move_string(best_move);
+        uci_send(info.str());
+    }
+
+    // One "go", handed from the input loop to the worker
+    struct UciJob {
+        Board board;
+        std::vector<std::uint64_t> history;  // repetition history is per thread
+        int max_depth = UCI_MAX_DEPTH;
+        TimeControl tc;
+        bool infinite = false;
+    };
+
+    struct UciState {
+        Board board = make_starting_position();
+        std::thread worker;
+
+        // Everything below is guarded by stop_mutex; stop_cv signals any change
+        std::mutex stop_mutex;
+        std::condition_variable stop_cv;
+        UciJob job;
+        bool job_pending = false;  // job is waiting for the worker
+        bool searching = false;    // a "go" has not answered with bestmove yet
+        bool quit = false;
+
+        // "go infinite" must not answer before "stop", and "go ponder" not
+        // before "stop" or "ponderhit", even if the search ends
+        bool stop_received = false;
+        bool pondering = false;
+    };
+
+    // The worker: waits for a job, searches, answers, waits again
+    void uci_worker(UciState& state) {
+        while (true) {
+            UciJob job;
+            {
+                std::unique_lock<std::mutex> lock(state.stop_mutex);
+                state.stop_cv.wait(lock, [&state] { return state.job_pending || state.quit; });
+                if (state.quit) return;
+                job = std::move(state.job);
+                state.job_pending = false;
+            }
+
+            set_position_history(job.history);
+            move best = find_best_move(job.board, job.max_depth, job.tc);
+            {
+                std::unique_lock<std::mutex> lock(state.stop_mutex);
+                state.stop_cv.wait(lock, [&state, &job] {
+                    return state.stop_received || (!job.infinite && !state.pondering);
+                });
+            }
+
+            std::string reply = "bestmove " + uci_move_string(best);
+            move ponder_move;
+            if (get_ponder_move(job.board, best, ponder_move)) {
+                reply += " ponder " + uci_move_string(ponder_move);
+            }
+            uci_send(reply);
+
+            {
+                std::lock_guard<std::mutex> lock(state.stop_mutex);
+                state.searching = false;
+            }
+            state.stop_cv.notify_all();
+        }
+    }
+
+    // Stop the running search (if any) and wait for its bestmove
+    void uci_stop_search(UciState& state) {
+        {
+            std::lock_guard<std::mutex> lock(state.stop_mutex);
+            state.stop_received = true;
+        }
+        state.stop_cv.notify_all();
+        request_search_stop();
+        std::unique_lock<std::mutex> lock(state.stop_mutex);
+        state.stop_cv.wait(lock, [&state] { return !state.searching; });
+    }
+
+    // position (startpos | fen <fen>) [moves m1 m2 ...]
+    void uci_position(UciState& state, std::istringstream& args) {
+        std::string token;
+        args >> token;
+        if (token == "startpos") {
+            state.board = make_starting_position();
+            args >> token;  // "moves", if any
+        } else if (token == "fen") {
+            std::string fen;
+            while (args >> token && token != "moves") {
+                fen += token + ' ';
+            }
+            if (!board_from_fen(fen, state.board)) {
+                uci_send("info string invalid FEN " + fen);
+                return;
+            }
+        } else {
+            uci_send("info string expected 'position startpos' or 'position fen'");
+            return;
+        }
+
         clear_position_history();
-        add_position_to_history(compute_zobrist(board));
-        
-        if (!history_file.is_open()) {
-            std::cerr << "Warning: History file not found. Assuming starting position.\n";
-            return board;
+        add_position_to_history(state.board.zobrist_hash);
+
+        while (args >> token) {
+            move m = parse_move(token);
+            if (!is_legal(state.board, m)) {
+                uci_send("info string illegal move " + token + ", ignoring the rest");
+                return;
+            }
+            make_move(state.board, m);
+            add_position_to_history(state.board.zobrist_hash);
+        }
+    }
+
+    // ponderhit: the expected move was played, keep the search going on the clock
+    void uci_ponderhit(UciState& state) {
+        {
+            std::lock_guard<std::mutex> lock(state.stop_mutex);
+            state.pondering = false;
+        }
+        set_search_pondering(false);
+        state.stop_cv.notify_all();
+    }
+
+    // go [ponder] [wtime N] [btime N] [winc N] [binc N] [movestogo N] [movetime N]
+    //    [depth N] [nodes N] [infinite]
+    void uci_go(UciState& state, std::istringstream& args) {
+        TimeControl tc;
+        int max_depth = UCI_MAX_DEPTH;
+        bool infinite = false;
+        bool ponder = false;
+        const bool white = state.board.side_to_move == Color::White;
+
+        std::string token;
+        while (args >> token) {
+            long long value = 0;
+            if (token == "infinite") {
+                infinite = true;
+                continue;
+            }
+            if (token == "ponder") {
+                ponder = true;
+                continue;
+            }
+            if (!(args >> value)) break;
+            if (token == "wtime" && white) tc.clock_ms = static_cast<int>(std::max(1LL, value));
+            else if (token == "btime" && !white) tc.clock_ms = static_cast<int>(std::max(1LL, value));
+            else if (token == "winc" && white) tc.increment_ms = static_cast<int>(value);
+            else if (token == "binc" && !white) tc.increment_ms = static_cast<int>(value);
+            else if (token == "movestogo") tc.moves_to_go = static_cast<int>(value);
+            else if (token == "movetime") {
+                tc.move_time_ms = static_cast<int>(std::max(1LL, value));
+                tc.fixed_move_time = true;
+            }
+            else if (token == "depth") max_depth = static_cast<int>(std::max(1LL, value));
+            else if (token == "nodes") tc.max_nodes = static_cast<std::uint64_t>(std::max(1LL, value));
+        }
+        if (infinite) tc = TimeControl{};
+
+        set_search_pondering(ponder);
+        reset_search_stop();
+        g_uci_search_start = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(state.stop_mutex);
+            state.stop_received = false;
+            state.pondering = ponder;
+            state.job.board = state.board;
+            state.job.history = get_position_history();
+            state.job.max_depth = max_depth;
+            state.job.tc = tc;
+            state.job.infinite = infinite;
+            state.job_pending = true;
+            state.searching = true;
         }
+        state.stop_cv.notify_all();
+    }
+
+    // setoption name <Hash|Threads> value N
+    void uci_setoption(std::istringstream& args) {
+        std::string token, name, value;
+        args >> token;  // "name"
+        while (args >> token && token != "value") {
+            name += (name.empty() ? "" : " ") + token;
+        }
+        args >> value;
+        if (name == "Ponder") return;  // the GUI decides when to send "go ponder"
+
+        int number = 0;
+        if (!parse_int(value.c_str(), number)) {
+            uci_send("info string bad value for option " + name);
+            return;
+        }
+        if (name == "Hash") {
+            number = std::max(1, std::min(number, UCI_MAX_HASH_MB));
+            resize_transposition_table(static_cast<std::size_t>(number));
+        } else if (name == "Threads") {
+            // The search itself is single-threaded; more threads are accepted but unused
+            if (number != 1) uci_send("info string search is single-threaded, using 1 thread");
+        } else {
+            uci_send("info string unknown option " + name);
+        }
+    }
+
+    int run_uci_loop() {
+        UciState state;
+        clear_position_history();
+        add_position_to_history(state.board.zobrist_hash);
+        set_iteration_callback(on_uci_iteration);
+        state.worker = std::thread(uci_worker, std::ref(state));
 
         std::string line;
-        while (std::getline(history_file, line)) {
-            // Trim whitespace (including \r)
-            while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back()))) {
-                line.pop_back();
+        while (std::getline(std::cin, line)) {
+            std::istringstream args(line);
+            std::string command;
+            args >> command;
+
+            if (command == "uci") {
+                uci_send("id name chess-king");
+                uci_send("id author chess-king developers");
+                uci_send("option name Hash type spin default " + std::to_string(UCI_DEFAULT_HASH_MB) +
+                         " min 1 max " + std::to_string(UCI_MAX_HASH_MB));
+                uci_send("option name Threads type spin default 1 min 1 max 1");
+                uci_send("option name Ponder type check default false");
+                uci_send("uciok");
+            } else if (command == "isready") {
+                uci_send("readyok");
+            } else if (command == "ucinewgame") {
+                uci_stop_search(state);
+                clear_transposition_table();
+            } else if (command == "position") {
+                uci_stop_search(state);
+                uci_position(state, args);
+            } else if (command == "go") {
+                uci_stop_search(state);
+                uci_go(state, args);
+            } else if (command == "stop") {
+                uci_stop_search(state);
+            } else if (command == "ponderhit") {
+                uci_ponderhit(state);
+            } else if (command == "setoption") {
+                uci_stop_search(state);
+                uci_setoption(args);
+            } else if (command == "quit") {
+                break;
             }
-            while (!line.empty() && std::isspace(static_cast<unsigned char>(line.front()))) {
-                line.erase(0, 1);
+        }
+
+        uci_stop_search(state);
+        {
+            std::lock_guard<std::mutex> lock(state.stop_mutex);
+            state.quit = true;
+        }
+        state.stop_cv.notify_all();
+        state.worker.join();
+        return 0;
+    }
+
+    // =====================================================================
+    // DAEMON MODE - stay resident and answer every change of the history file
+    // =====================================================================
+    // The orchestrator keeps its protocol (write -H, wait for -m), but the
+    // process lives across turns, so a turn no longer pays for start-up, TT
+    // allocation and replaying the whole game. The retained Board only gets
+    // the moves appended since the last turn; the TT, history tables and the
+    // repetition stack carry over. A history that no longer extends ours (a
+    // new game) is replayed from the start.
+    //
+    // We answer whenever the history differs from what it was after our last
+    // reply, so the orchestrator appending our own move doesn't trigger a
+    // search. On Linux we sleep in inotify on the history file's directory
+    // (which also sees files replaced by rename); elsewhere we poll.
+    // =====================================================================
+
+    constexpr int DAEMON_POLL_MS = 10;  // Polling fallback without inotify
+
+    struct DaemonGame {
+        Board start = make_starting_position();  // -F position, or the usual one
+        Board board = make_starting_position();
+        std::vector<std::string> moves;     // moves applied to board
+        std::vector<std::string> answered;  // history after our last reply (incl. our move)
+        bool replied = false;               // answered is meaningful (empty is a valid history)
+    };
+
+    void reset_daemon_game(DaemonGame& game) {
+        game.board = game.start;
+        game.moves.clear();
+        clear_position_history();
+        add_position_to_history(game.board.zobrist_hash);
+    }
+
+    // Bring GAME up to LINES, applying only moves it doesn't have yet.
+    // Returns false if a move doesn't parse or isn't legal - usually a file
+    // caught half-written; the next change event will try again.
+    bool sync_daemon_game(DaemonGame& game, const std::vector<std::string>& lines) {
+        bool extends = lines.size() >= game.moves.size() &&
+                       std::equal(game.moves.begin(), game.moves.end(), lines.begin());
+        if (!extends) {
+            std::cerr << "Daemon: history was rewritten, replaying from the start\n";
+            reset_daemon_game(game);
+        }
+
+        for (std::size_t i = game.moves.size(); i < lines.size(); ++i) {
+            move m = parse_move(lines[i]);
+            if (!is_legal(game.board, m)) {
+                std::cerr << "Daemon: illegal or incomplete move '" << lines[i] << "', waiting\n";
+                return false;
             }
+            make_move(game.board, m);
+            add_position_to_history(game.board.zobrist_hash);
+            game.moves.push_back(lines[i]);
+        }
+        return true;
+    }
 
-            if (!line.empty()) {
-                move_history.push_back(line); 
-                move m = parse_move(line);
-                
-                // VALIDATION: Check that the move is legal before applying
-                // This catches history file corruption or format mismatches
-                std::vector<move> legal = generate_legal_moves(board);
-                bool is_valid = false;
-                for (const auto& lm : legal) {
-                    if (lm.from_row == m.from_row && lm.from_col == m.from_col &&
-                        lm.to_row == m.to_row && lm.to_col == m.to_col &&
-                        lm.promotion == m.promotion) {
-                        is_valid = true;
-                        break;
-                    }
+    // Re-read the history file and reply if it's our turn
+    void daemon_turn(DaemonGame& game, const ProgramOptions& options) {
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::string> lines;
+        if (!read_history_lines(options.history_path, lines) ||
+            (game.replied && lines == game.answered)) {
+            return;  // Nothing new for us (or just our own move echoed back)
+        }
+        if (!sync_daemon_game(game, lines)) {
+            return;
+        }
+
+        std::vector<move> legal = generate_legal_moves(game.board);
+        if (legal.empty()) {
+            std::cerr << "Daemon: no legal moves (checkmate or stalemate)\n";
+            game.answered = lines;
+            game.replied = true;
+            return;
+        }
+
+        bool from_book = false;
+        move best_move = choose_move(game.board, game.moves, legal, options.time_control, from_book,
+                                     options.fen.empty());
+        if (!write_move_to_file(best_move, options.move_path)) {
+            return;
+        }
+        game.answered = lines;
+        game.answered.push_back(move_to_uci(best_move));
+        game.replied = true;
+
+        auto ms = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count() / 1000.0;
+        std::cerr << "Daemon: replied " << move_to_uci(best_move) << " to move " << lines.size()
+                  << " in " << ms << " ms (" << (from_book ? "book" : "search") << ")\n";
+    }
+
+    int run_history_daemon(const ProgramOptions& options) {
+        DaemonGame game;
+        if (!options.fen.empty() && !board_from_fen(options.fen, game.start)) {
+            std::cerr << "Invalid FEN: " << options.fen << '\n';
+            return 1;
+        }
+        reset_daemon_game(game);
+
+        // The orchestrator may already be waiting on a history written before we started
+        daemon_turn(game, options);
+
+#ifdef __linux__
+        const std::string& path = options.history_path;
+        const std::size_t slash = path.find_last_of('/');
+        const std::string dir = slash == std::string::npos ? "." : path.substr(0, slash == 0 ? 1 : slash);
+        const std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+
+        int fd = inotify_init1(IN_CLOEXEC);
+        // Only completed writes: a rewrite truncates the file first, and reacting
+        // to that (IN_MODIFY) would answer an empty history
+        if (fd >= 0 && inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) >= 0) {
+            std::cerr << "Daemon: watching " << path << " (inotify)\n";
+            alignas(inotify_event) char buffer[4096];
+            while (true) {
+                ssize_t length = read(fd, buffer, sizeof(buffer));
+                if (length <= 0) break;
+
+                // One turn per batch of events, however many concern our file
+                bool ours = false;
+                for (char* p = buffer; p < buffer + length;) {
+                    const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                    if (event->len > 0 && name == event->name) ours = true;
+                    p += sizeof(inotify_event) + event->len;
                 }
-                
-                if (!is_valid) {
-                    std::cerr << "ERROR: Illegal move in history file: '" << line << "'\n";
-                    std::cerr << "  Parsed as: (" << m.from_row << "," << m.from_col 
-                              << ")->(" << m.to_row << "," << m.to_col << ")\n";
-                    // Continue anyway to see full error output
+                if (ours) daemon_turn(game, options);
+            }
+            close(fd);
+            std::cerr << "Daemon: inotify failed, falling back to polling\n";
+        } else if (fd >= 0) {
+            close(fd);
+        }
+#endif
+
+        std::cerr << "Daemon: polling " << options.history_path << " every " << DAEMON_POLL_MS << " ms\n";
+        while (true) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(DAEMON_POLL_MS));
+            daemon_turn(game, options);
+        }
+    }
+
+    // =====================================================================
+    // SERVER MODE - many games at once over a local Unix socket
+    // =====================================================================
+    // One process serves any number of independent games. Clients connect to
+    // the socket and send lines of the form
+    //
+    //     <game-id> [move ...]     the game's moves so far -> "<game-id> <move>"
+    //     <game-id> end            forget the game          -> "<game-id> ok"
+    //
+    // Errors are answered with "<game-id> error <reason>", and a position
+    // without legal moves with "<game-id> none". Like the daemon, a session
+    // only applies the moves appended since its last request and replays a
+    // history that no longer extends its own.
+    //
+    // Each session owns its Board, its repetition history and its clock: -t/-i/-g
+    // give every new game the same budget, and the time actually spent is
+    // charged to that game alone. Without -t every move gets the fixed think
+    // time, as in the other modes.
+    //
+    // Searches run on a fixed pool of workers (-w, default one per core), so
+    // games beyond that wait in a queue instead of sharing cores. Requests for
+    // the same game are answered in order: a worker skips jobs of a game that
+    // is already being searched. All workers share the transposition table
+    // without locks (each slot is checked against its key, so a slot torn by
+    // two workers reads as a miss); history tables, search stacks and clocks
+    // are per worker thread.
+    // =====================================================================
+
+    struct ServerConnection {
+        int fd = -1;
+        std::mutex write_mutex;  // replies from several workers
+
+        ~ServerConnection() {
+#ifdef __unix__
+            if (fd >= 0) close(fd);
+#endif
+        }
+    };
+
+    struct ServerJob {
+        std::shared_ptr<ServerConnection> connection;
+        std::string game_id;
+        std::vector<std::string> moves;
+        bool end_game = false;
+    };
+
+    struct ServerSession {
+        Board board = make_starting_position();
+        std::vector<std::string> moves;      // moves applied to board
+        std::vector<std::uint64_t> hashes;   // repetition history of board
+        TimeControl clock;                   // what is left of this game's budget
+    };
+
+    struct ServerState {
+        TimeControl initial_clock;
+
+        std::mutex mutex;  // guards everything below
+        std::condition_variable job_ready;
+        std::deque<ServerJob> jobs;
+        std::set<std::string> busy_games;  // games a worker is searching right now
+        std::map<std::string, std::unique_ptr<ServerSession>> sessions;
+    };
+
+    void server_reply(ServerConnection& connection, const std::string& line) {
+#ifdef __unix__
+        const std::string text = line + '\n';
+        std::lock_guard<std::mutex> lock(connection.write_mutex);
+        std::size_t sent = 0;
+        while (sent < text.size()) {
+            // MSG_NOSIGNAL: a client that hung up must not kill the server
+            ssize_t n = send(connection.fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return;
+            sent += static_cast<std::size_t>(n);
+        }
+#else
+        (void)connection;
+        (void)line;
+#endif
+    }
+
+    void reset_server_session(ServerSession& session) {
+        session.board = make_starting_position();
+        session.moves.clear();
+        session.hashes.assign(1, session.board.zobrist_hash);
+    }
+
+    // Bring SESSION up to MOVES. Returns an error message, or "" on success.
+    std::string sync_server_session(ServerSession& session, const std::vector<std::string>& moves) {
+        bool extends = moves.size() >= session.moves.size() &&
+                       std::equal(session.moves.begin(), session.moves.end(), moves.begin());
+        if (!extends) {
+            reset_server_session(session);
+        }
+
+        for (std::size_t i = session.moves.size(); i < moves.size(); ++i) {
+            move m = parse_move(moves[i]);
+            if (!is_legal(session.board, m)) {
+                // Keep what was valid; the client can resend a corrected history
+                return "illegal move " + moves[i];
+            }
+            make_move(session.board, m);
+            session.hashes.push_back(session.board.zobrist_hash);
+            session.moves.push_back(moves[i]);
+        }
+        return "";
+    }
+
+    // Charge SPENT_MS to the session's clock, with increment and a new
+    // period when a -g control is reached
+    void charge_session_clock(ServerSession& session, const TimeControl& initial, long long spent_ms) {
+        TimeControl& clock = session.clock;
+        if (clock.clock_ms <= 0) return;  // fixed time per move
+
+        long long left = std::max(1LL, clock.clock_ms - spent_ms) + clock.increment_ms;
+        if (clock.moves_to_go > 0 && --clock.moves_to_go == 0) {
+            clock.moves_to_go = initial.moves_to_go;
+            left += initial.clock_ms;
+        }
+        clock.clock_ms = static_cast<int>(std::min<long long>(left, std::numeric_limits<int>::max()));
+    }
+
+    // Answer one request. Runs on a worker, which owns the session meanwhile.
+    void run_server_job(ServerState& state, const ServerJob& job) {
+        ServerSession* session = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (job.end_game) {
+                state.sessions.erase(job.game_id);
+            } else {
+                std::unique_ptr<ServerSession>& slot = state.sessions[job.game_id];
+                if (!slot) {
+                    slot.reset(new ServerSession());
+                    reset_server_session(*slot);
+                    slot->clock = state.initial_clock;
                 }
-                
-                // Replay the move
-                make_move(board, m);
-                
-                // REPETITION TRACKING: Store position hash after each move
-                // This builds the history of all positions in the game
-                // so we can detect threefold repetition
-                add_position_to_history(compute_zobrist(board));
+                session = slot.get();
             }
         }
-        
-        std::cerr << "Position history: " << get_position_history_size() << " positions tracked\n";
-        
-        return board;
+        if (job.end_game) {
+            server_reply(*job.connection, job.game_id + " ok");
+            return;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const std::string error = sync_server_session(*session, job.moves);
+        if (!error.empty()) {
+            server_reply(*job.connection, job.game_id + " error " + error);
+            return;
+        }
+
+        std::vector<move> legal = generate_legal_moves(session->board);
+        if (legal.empty()) {
+            server_reply(*job.connection, job.game_id + " none");
+            return;
+        }
+
+        set_position_history(session->hashes);  // the search reads this thread's copy
+        bool from_book = false;
+        move best_move = choose_move(session->board, session->moves, legal, session->clock, from_book);
+
+        const long long spent_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        charge_session_clock(*session, state.initial_clock, spent_ms);
+        server_reply(*job.connection, job.game_id + " " + move_to_uci(best_move));
+    }
+
+    void run_server_worker(ServerState& state) {
+        while (true) {
+            ServerJob job;
+            {
+                std::unique_lock<std::mutex> lock(state.mutex);
+                auto next = state.jobs.end();
+                state.job_ready.wait(lock, [&state, &next] {
+                    next = std::find_if(state.jobs.begin(), state.jobs.end(), [&state](const ServerJob& j) {
+                        return state.busy_games.count(j.game_id) == 0;
+                    });
+                    return next != state.jobs.end();
+                });
+                job = std::move(*next);
+                state.jobs.erase(next);
+                state.busy_games.insert(job.game_id);
+            }
+
+            run_server_job(state, job);
+
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                state.busy_games.erase(job.game_id);
+            }
+            // A job of this game may be waiting for it
+            state.job_ready.notify_all();
+        }
+    }
+
+    // Turn the lines a client sends into jobs until it hangs up
+    void read_server_connection(ServerState& state, std::shared_ptr<ServerConnection> connection) {
+#ifdef __unix__
+        std::string pending;
+        char buffer[4096];
+        while (true) {
+            ssize_t n = recv(connection->fd, buffer, sizeof(buffer), 0);
+            if (n <= 0) return;
+            pending.append(buffer, static_cast<std::size_t>(n));
+
+            std::size_t newline;
+            while ((newline = pending.find('\n')) != std::string::npos) {
+                std::istringstream words(pending.substr(0, newline));
+                pending.erase(0, newline + 1);
+
+                ServerJob job;
+                job.connection = connection;
+                if (!(words >> job.game_id)) continue;  // blank line
+                std::string word;
+                while (words >> word) job.moves.push_back(word);
+                job.end_game = job.moves.size() == 1 && job.moves.front() == "end";
+
+                {
+                    std::lock_guard<std::mutex> lock(state.mutex);
+                    state.jobs.push_back(std::move(job));
+                }
+                state.job_ready.notify_one();
+            }
+        }
+#else
+        (void)state;
+        (void)connection;
+#endif
+    }
+
+    int run_game_server(const ProgramOptions& options) {
+#ifdef __unix__
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (options.socket_path.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Server: socket path too long: " << options.socket_path << '\n';
+            return 1;
+        }
+        std::copy(options.socket_path.begin(), options.socket_path.end(), address.sun_path);
+
+        int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0) {
+            std::cerr << "Server: could not create socket\n";
+            return 1;
+        }
+        unlink(options.socket_path.c_str());  // left behind by an earlier server
+        if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listen_fd, SOMAXCONN) != 0) {
+            std::cerr << "Server: could not listen on " << options.socket_path << '\n';
+            close(listen_fd);
+            return 1;
+        }
+
+        // Lives until the process exits: the detached workers and readers use it
+        ServerState& state = *new ServerState();
+        state.initial_clock = options.time_control;
+
+        int workers = options.workers;
+        if (workers <= 0) {
+            workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        }
+        for (int i = 0; i < workers; ++i) {
+            std::thread(run_server_worker, std::ref(state)).detach();
+        }
+        std::cerr << "Server: listening on " << options.socket_path << " with " << workers << " workers\n";
+
+        while (true) {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                std::cerr << "Server: accept failed\n";
+                break;
+            }
+            auto connection = std::make_shared<ServerConnection>();
+            connection->fd = fd;
+            std::thread(read_server_connection, std::ref(state), connection).detach();
+        }
+        close(listen_fd);
+        return 1;
+#else
+        (void)options;
+        std::cerr << "Server mode needs Unix domain sockets, which this platform lacks\n";
+        return 1;
+#endif
     }
 
 } // namespace
 
 int main(int argc, char* argv[]) {
+    const auto program_start = std::chrono::steady_clock::now();
+
+    // No arguments: we were started by a UCI GUI or match runner
+    if (argc == 1) {
+        init_zobrist();
+        return run_uci_loop();
+    }
 
     ProgramOptions options;
     if (!parse_arguments(argc, argv, options)) {
@@ -197,12 +1227,56 @@ int main(int argc, char* argv[]) {
     // Initialize Zobrist hash tables (required for future transposition table)
     init_zobrist();
 
+    if (!options.socket_path.empty()) {
+        return run_game_server(options);
+    }
+
+    if (options.bench_depth > 0) {
+        if (options.perft_scaling) {
+            return bench_scaling(options.bench_depth, options.workers) ? 0 : 1;
+        }
+        return run_bench(options.bench_depth) ? 0 : 1;
+    }
+
+    if (options.perft_suite) {
+        return run_perft_suite(options.perft_suite_depth, options.workers, options.perft_hash_mb) ? 0 : 1;
+    }
+    if (options.perft_depth >= 0) {
+        Board board = make_starting_position();
+        if (!options.fen.empty() && !board_from_fen(options.fen, board)) {
+            std::cerr << "Invalid FEN: " << options.fen << '\n';
+            return 1;
+        }
+        if (options.perft_scaling) {
+            perft_scaling(board, options.perft_depth, options.workers, options.perft_hash_mb);
+            return 0;
+        }
+        std::unique_ptr<PerftTable> table;
+        if (options.perft_hash_mb > 0) table.reset(new PerftTable(options.perft_hash_mb));
+        perft_divide(board, options.perft_depth, options.workers, table.get());
+        return 0;
+    }
+
+    if (options.daemon) {
+        return run_history_daemon(options);
+    }
+
     std::cout << "chess-king running...\n";
     
     // 1. Parse history and reconstruct board state
+    Board start = make_starting_position();
+    if (!options.fen.empty() && !board_from_fen(options.fen, start)) {
+        std::cerr << "Invalid FEN: " << options.fen << '\n';
+        return 1;
+    }
     std::vector<std::string> move_history;
-    Board board = parse_history(options.history_path, move_history);
+    Board board = parse_history(start, options.history_path, move_history);
     
+    // Pick up the table the previous run (and its ponder search) left behind
+    if (!options.hash_path.empty()) {
+        resume_from_hash_file(options.hash_path);
+    }
+
     // Display board state for verification (helps verify history was loaded correctly)
     print_board(board);
     
@@ -218,61 +1292,44 @@ int main(int argc, char* argv[]) {
         std::cerr << "No legal moves available! (Checkmate or Stalemate)\n";
         return 0; // safely exit
     }
+
+    // From here on a move file is guaranteed: if we are still busy at the
+    // deadline, the watchdog writes the best move found so far and exits
+    start_move_watchdog(options.move_path,
+                        program_start + std::chrono::milliseconds(options.deadline_ms),
+                        moves.front(), options.anytime);
+    set_iteration_callback(on_iteration_complete);
     
-    // 3. Search for the best move using Negamax with time control
-    // Iterative deepening: starts at depth 1, increases until time runs out
-    // TIME_LIMIT_MS: Stay well under tournament time limit to prevent timeouts
-    // Check opening book FIRST before searching
-    move best_move(0, 0, 0, 0);
-    move book_move = get_book_move(move_history);
-
-    // Check if book move is valid (not 0,0,0,0)
-    bool have_book_move = (book_move.from_row != 0 || book_move.from_col != 0 || 
-                        book_move.to_row != 0 || book_move.to_col != 0);
-
-    if (have_book_move) {
-        // We have a book move! Use it instantly
-        std::cout << "Playing opening book move!\n";
-        best_move = book_move;
-    } else {
-        // Not in book - search for best move using Negamax with time control
-        constexpr int MAX_SEARCH_DEPTH = 20;  // Maximum depth to search
-        constexpr int TIME_LIMIT_MS = 9300;   // 9.3 second limit
-        best_move = find_best_move(board, MAX_SEARCH_DEPTH, TIME_LIMIT_MS);
-    }
-
-    // SAFETY CHECK: Validate that best_move is actually in the legal moves list
-    // This prevents writing invalid moves that could cause the engine to lose
-    // This should never happen, but it's a critical safety check
-    bool is_legal = false;
-    for (const auto& legal_move : moves) {
-        // Compare all fields: from/to squares and promotion
-        if (legal_move.from_row == best_move.from_row &&
-            legal_move.from_col == best_move.from_col &&
-            legal_move.to_row == best_move.to_row &&
-            legal_move.to_col == best_move.to_col &&
-            legal_move.promotion == best_move.promotion) {
-            is_legal = true;
-            break;
-        }
-    }
-
-    if (!is_legal) {
-        std::cerr << "Warning: Best move " << move_to_uci(best_move) 
-                  << " is not in legal moves list! Using first legal move as fallback.\n";
-        if (!moves.empty()) {
-            best_move = moves.front();
-        } else {
-            std::cerr << "Fatal: No legal moves available!\n";
-            return 1;
-        }
-    }
+    // 3. Search for the best move using Negamax with time control. The
+    // watchdog counts from program start, so the search budget must too
+    const int spent_ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - program_start).count());
+    bool from_book = false;
+    move best_move = choose_move(board, move_history, moves, options.time_control, from_book,
+                                 options.fen.empty(), spent_ms);
 
     // 4. Write the move using move.h function
+    // Disarm the watchdog first so it can't overwrite the final move
+    stop_move_watchdog();
     if (!write_move_to_file(best_move, options.move_path)) {
         return 1;
     }
 
     std::cout << "Wrote move " << move_to_uci(best_move) << " to " << options.move_path << '\n';
+
+    // 5. Ponder on the opponent's time: search the position after the reply
+    // we expect while they think, leaving the result in the hash file
+    if (!options.hash_path.empty()) {
+        Board after = board;
+        make_move(after, best_move);
+        add_position_to_history(after.zobrist_hash);
+        move expected_reply;
+        if (get_ponder_move(board, best_move, expected_reply)) {
+            std::cout << "Pondering on " << move_to_uci(expected_reply) << '\n';
+            make_move(after, expected_reply);
+            add_position_to_history(after.zobrist_hash);
+        }
+        ponder_in_background(after, options.hash_path);
+    }
     return 0;
 }
@@ -0,0 +1,220 @@
+// chess-king-bench: times the engine's hot primitives one at a time.
+//
+// Positions come from random playouts with a fixed seed, so every run (and
+// every build) times the same realistic mix of openings, middlegames and
+// endgames. Each primitive is warmed up, then timed over several samples of
+// one pass across all positions; the report gives ns per call as mean,
+// standard deviation and best sample.
+//
+// Usage: chess-king-bench [samples]
+
+#include "board.h"
+#include "attacks.h"
+#include "../t_table.h"
+#include "../zobrist_h.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// from 4_select_best_move.cpp
+extern int move_ordering_score(const Board& board, const move& m, int ply);
+
+namespace {
+
+constexpr int POSITION_COUNT = 1000;
+constexpr int MIN_PLY = 8;          // skip the first moves: every playout starts alike
+constexpr int MAX_PLY = 120;
+constexpr int WARMUP_PASSES = 2;
+constexpr int DEFAULT_SAMPLES = 10;
+constexpr std::uint32_t SEED = 20240601;
+
+struct BenchPosition {
+    Board board;
+    std::vector<move> moves;  // its legal moves
+};
+
+// Positions along random games, each with at least one legal move
+std::vector<BenchPosition> make_positions() {
+    std::mt19937 rng(SEED);
+    std::vector<BenchPosition> positions;
+    positions.reserve(POSITION_COUNT);
+
+    while (static_cast<int>(positions.size()) < POSITION_COUNT) {
+        Board board = make_starting_position();
+        const int length = MIN_PLY + static_cast<int>(rng() % (MAX_PLY - MIN_PLY));
+        for (int ply = 0; ply < length; ++ply) {
+            std::vector<move> moves = generate_legal_moves(board);
+            if (moves.empty()) break;
+            if (ply >= MIN_PLY && rng() % 8 == 0) {
+                positions.push_back({board, moves});
+                if (static_cast<int>(positions.size()) == POSITION_COUNT) break;
+            }
+            make_move(board, moves[rng() % moves.size()]);
+        }
+    }
+    return positions;
+}
+
+// Keeps results alive so the compiler can't drop the timed calls
+volatile std::uint64_t g_sink = 0;
+
+// One pass calls the primitive OPS times; returns ns per call of each sample
+std::vector<double> time_samples(const std::function<std::uint64_t()>& pass, std::uint64_t ops, int samples) {
+    for (int i = 0; i < WARMUP_PASSES; ++i) {
+        g_sink = g_sink + pass();
+    }
+
+    std::vector<double> ns_per_op;
+    for (int i = 0; i < samples; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        g_sink = g_sink + pass();
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        ns_per_op.push_back(static_cast<double>(ns) / static_cast<double>(ops));
+    }
+    return ns_per_op;
+}
+
+void report(const std::string& name, const std::vector<double>& ns_per_op, std::uint64_t ops) {
+    double mean = 0;
+    for (double v : ns_per_op) mean += v;
+    mean /= ns_per_op.size();
+    double variance = 0;
+    for (double v : ns_per_op) variance += (v - mean) * (v - mean);
+    variance /= ns_per_op.size();
+    const double best = *std::min_element(ns_per_op.begin(), ns_per_op.end());
+
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << mean << " ns/op"
+              << "  +/- " << std::setw(8) << std::sqrt(variance)
+              << "  (best " << std::setw(10) << best << ")"
+              << "  " << ops << " ops/pass\n";
+}
+
+void run(const std::string& name, std::uint64_t ops, int samples, const std::function<std::uint64_t()>& pass) {
+    report(name, time_samples(pass, ops, samples), ops);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int samples = DEFAULT_SAMPLES;
+    if (argc > 1) {
+        samples = std::max(1, std::atoi(argv[1]));
+    }
+
+    init_zobrist();
+    std::vector<BenchPosition> positions = make_positions();
+
+    std::uint64_t move_count = 0;
+    for (const BenchPosition& p : positions) move_count += p.moves.size();
+    const std::uint64_t position_count = positions.size();
+
+    std::cout << position_count << " positions, " << move_count << " legal moves, "
+              << samples << " samples after " << WARMUP_PASSES << " warm-up passes\n\n";
+
+    run("generate_legal_moves", position_count, samples, [&positions] {
+        std::vector<move> buffer;
+        std::uint64_t sum = 0;
+        for (const BenchPosition& p : positions) {
+            generate_legal_moves(p.board, buffer);
+            sum += buffer.size();
+        }
+        return sum;
+    });
+
+    run("make_move+unmake_move", move_count, samples, [&positions] {
+        std::uint64_t sum = 0;
+        Undo undo;
+        for (BenchPosition& p : positions) {
+            for (const move& m : p.moves) {
+                make_move(p.board, m, undo);
+                sum += p.board.zobrist_hash;
+                unmake_move(p.board, m, undo);
+            }
+        }
+        return sum;
+    });
+
+    // Every square, attacked by the side not to move
+    run("is_attacked", position_count * 64, samples, [&positions] {
+        std::uint64_t sum = 0;
+        for (const BenchPosition& p : positions) {
+            const Color them = p.board.side_to_move == Color::White ? Color::Black : Color::White;
+            for (int sq = 0; sq < 64; ++sq) {
+                sum += is_attacked(p.board, sq / 8, sq % 8, them);
+            }
+        }
+        return sum;
+    });
+
+    run("is_in_check", position_count, samples, [&positions] {
+        std::uint64_t sum = 0;
+        for (const BenchPosition& p : positions) {
+            sum += is_in_check(p.board, p.board.side_to_move);
+        }
+        return sum;
+    });
+
+    run("compute_zobrist", position_count, samples, [&positions] {
+        std::uint64_t sum = 0;
+        for (const BenchPosition& p : positions) {
+            sum += compute_zobrist(p.board);
+        }
+        return sum;
+    });
+
+    run("evaluate_board", position_count, samples, [&positions] {
+        std::uint64_t sum = 0;
+        for (const BenchPosition& p : positions) {
+            sum += static_cast<std::uint64_t>(evaluate_board(p.board));
+        }
+        return sum;
+    });
+
+    run("calculate_move_score", move_count, samples, [&positions] {
+        std::uint64_t sum = 0;
+        for (const BenchPosition& p : positions) {
+            for (const move& m : p.moves) {
+                sum += static_cast<std::uint64_t>(move_ordering_score(p.board, m, 0));
+            }
+        }
+        return sum;
+    });
+
+    // Random keys spread over a 64 MB table, far more slots than any cache
+    // holds, so probes and stores pay for cache misses as in a real search
+    constexpr std::size_t TT_KEY_COUNT = 1 << 20;
+    std::mt19937_64 key_rng(SEED);
+    std::vector<std::uint64_t> tt_keys(TT_KEY_COUNT);
+    for (std::uint64_t& key : tt_keys) key = key_rng();
+    const move tt_move = positions.front().moves.front();
+
+    TranspositionTable tt(64);
+    run("tt.store", TT_KEY_COUNT, samples, [&tt_keys, &tt, &tt_move] {
+        for (std::uint64_t key : tt_keys) {
+            tt.store(key, 5, 17, TT_EXACT, &tt_move);
+        }
+        return static_cast<std::uint64_t>(tt_keys.size());
+    });
+
+    run("tt.probe", TT_KEY_COUNT, samples, [&tt_keys, &tt] {
+        std::uint64_t sum = 0;
+        TTentry entry;
+        for (std::uint64_t key : tt_keys) {
+            sum += tt.probe(key, entry);
+        }
+        return sum;
+    });
+
+    return 0;
+}
@@ -5,7 +5,13 @@ In this file we will setup the transposition table
 */
 
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
 #include <vector>
 #include "move.h"
 
@@ -29,6 +35,12 @@ struct TTentry
 };
 
 //representing the table
+//the table is shared by every search thread (server mode runs several games at once)
+//without locks: a slot holds two 64-bit words, the packed entry (data) and key ^ data
+//(check). a store writes both words, so a slot caught half-written by another thread
+//fails the check on probe and reads as a miss instead of mixing two positions.
+//probe() hands out a decoded copy for the same reason: the slot may change right after.
+//resize/clear/save/load touch the whole table and must only run while no search does.
 class TranspositionTable
 {
     public: //
@@ -41,53 +53,163 @@ class TranspositionTable
     void resize_mb(std::size_t mb)
     {
         std::size_t bytes = mb * 1024ULL * 1024ULL; //converts megabytes to bytes
-        std::size_t n = bytes / sizeof(TTentry); 
+        std::size_t n = bytes / sizeof(Slot); 
         if (n < 1) n = 1; //at least one entry
 
         // Round up to power of 2 for fast modulo via bitmask
         std::size_t pow2 = 1;
         while (pow2 < n) pow2 <<= 1;
-        table.assign(pow2, TTentry{});
+        table.reset(new Slot[pow2]);
+        slots = pow2;
         mask = pow2 - 1;
     }
 
     //clears table by resenting entries 
     void clear()
     {
-        std::fill(table.begin(), table.end(), TTentry{});
+        for (std::size_t i = 0; i < slots; ++i)
+        {
+            table[i].check.store(0, std::memory_order_relaxed);
+            table[i].data.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    //saves the table to a file (small header + raw slots) so the next process can start warm
+    //written to a temporary file and renamed, so readers never see half a table
+    bool save(const std::string& path) const
+    {
+        const std::string tmp_path = path + ".tmp";
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        const std::uint64_t header[3] = {FILE_MAGIC, sizeof(Slot), slots};
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        std::vector<std::uint64_t> buffer;
+        buffer.reserve(2 * IO_CHUNK);
+        for (std::size_t i = 0; i < slots; ++i)
+        {
+            buffer.push_back(table[i].check.load(std::memory_order_relaxed));
+            buffer.push_back(table[i].data.load(std::memory_order_relaxed));
+            if (buffer.size() == 2 * IO_CHUNK || i + 1 == slots)
+            {
+                out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(std::uint64_t));
+                buffer.clear();
+            }
+        }
+        out.close();
+        if (!out) return false;
+        return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+    }
+
+    //loads a table written by save(); the file must match this table's size and slot layout
+    bool load(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+
+        std::uint64_t header[3] = {};
+        in.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (!in || header[0] != FILE_MAGIC || header[1] != sizeof(Slot) || header[2] != slots) {
+            return false;
+        }
+        std::vector<std::uint64_t> buffer(2 * IO_CHUNK);
+        for (std::size_t first = 0; first < slots; first += IO_CHUNK)
+        {
+            const std::size_t count = std::min<std::size_t>(IO_CHUNK, slots - first);
+            in.read(reinterpret_cast<char*>(buffer.data()), 2 * count * sizeof(std::uint64_t));
+            if (!in) {
+                clear(); //partial read: don't keep a mix of old and new entries
+                return false;
+            }
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                table[first + i].check.store(buffer[2 * i], std::memory_order_relaxed);
+                table[first + i].data.store(buffer[2 * i + 1], std::memory_order_relaxed);
+            }
+        }
+        return true;
     }
 
-    TTentry* probe(std::uint64_t key)
+    //copies the entry for key into out; false if the slot holds another position
+    //(or was being rewritten while we read it)
+    bool probe(std::uint64_t key, TTentry& out) const
     {
-        TTentry& e = table[key & mask];
-        if (e.key == key) return &e;
-        return nullptr;
+        const Slot& slot = table[key & mask];
+        const std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+        const std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != key || data_depth(data) == 0) return false;
+        unpack(key, data, out);
+        return true;
     }
 
     //stores an entry in the table
     void store(std::uint64_t key, int depth, int value, TTflag flag, const move* best)
     {
-        TTentry& e = table[key & mask]; //gets the entry corresponding to the key
+        Slot& slot = table[key & mask]; //gets the slot corresponding to the key
+        const std::uint64_t old_data = slot.data.load(std::memory_order_relaxed);
+        const std::uint64_t old_check = slot.check.load(std::memory_order_relaxed);
+        const bool same_key = (old_check ^ old_data) == key && data_depth(old_data) != 0;
 
-        if (e.key != key || depth >= e.depth) //if key is different or depth is greater or equal, we replace the entry
+        //if key is different or depth is greater or equal, we replace the entry
+        if (!same_key || depth + 1 >= data_depth(old_data))
         {
-            e.key = key;
-            e.depth = depth;
-            e.value = value;
-            e.flag = flag;
-            if(best) //if there is a best move we save it, otherwuse store best move is false
-            {
-                e.best_move = *best;
-                e.has_move = true;
-            } else
+            const std::uint64_t data = pack(depth, value, flag, best);
+            slot.data.store(data, std::memory_order_relaxed);
+            slot.check.store(key ^ data, std::memory_order_relaxed);
+        }
+    }
+
+    private:
+        static constexpr std::uint64_t FILE_MAGIC = 0x324C4254474E494BULL; //"KINGTBL2"
+        static constexpr std::size_t IO_CHUNK = 4096; //slots per read/write in save/load
+
+        //data layout, low bit first: value (32) | depth + 1 (8, 0 = empty slot) | flag (2) |
+        //has_move (1) | from_row, from_col, to_row, to_col, promotion (3 each)
+        struct Slot {
+            std::atomic<std::uint64_t> check{0}; //key ^ data
+            std::atomic<std::uint64_t> data{0};
+        };
+
+        static int data_depth(std::uint64_t data)
+        {
+            return static_cast<int>((data >> 32) & 0xFF);
+        }
+
+        static std::uint64_t pack(int depth, int value, TTflag flag, const move* best)
+        {
+            const int stored_depth = std::max(1, std::min(depth + 1, 255));
+            std::uint64_t data = static_cast<std::uint32_t>(value);
+            data |= static_cast<std::uint64_t>(stored_depth) << 32;
+            data |= static_cast<std::uint64_t>(flag & 3) << 40;
+            if (best) //if there is a best move we save it, otherwise has_move stays false
             {
-                e.has_move= false;
+                data |= 1ULL << 42;
+                data |= static_cast<std::uint64_t>(best->from_row & 7) << 43;
+                data |= static_cast<std::uint64_t>(best->from_col & 7) << 46;
+                data |= static_cast<std::uint64_t>(best->to_row & 7) << 49;
+                data |= static_cast<std::uint64_t>(best->to_col & 7) << 52;
+                data |= static_cast<std::uint64_t>(best->promotion & 7) << 55;
+            }
+            return data;
+        }
 
+        static void unpack(std::uint64_t key, std::uint64_t data, TTentry& out)
+        {
+            out.key = key;
+            out.value = static_cast<std::int32_t>(static_cast<std::uint32_t>(data));
+            out.depth = data_depth(data) - 1;
+            out.flag = static_cast<TTflag>((data >> 40) & 3);
+            out.has_move = ((data >> 42) & 1) != 0;
+            out.best_move = move();
+            if (out.has_move)
+            {
+                out.best_move = move(static_cast<int>((data >> 43) & 7), static_cast<int>((data >> 46) & 7),
+                                     static_cast<int>((data >> 49) & 7), static_cast<int>((data >> 52) & 7),
+                                     static_cast<promotion_piece_type>((data >> 55) & 7));
             }
         }
-    }
 
-    private:
-        std::vector<TTentry> table;
+        std::unique_ptr<Slot[]> table;
+        std::size_t slots = 0;
         std::size_t mask = 0;
-};
\ No newline at end of file
+};
@@ -0,0 +1,109 @@
+// chess-king-position-checks: deterministic checks of the board code on the
+// positions in a FEN file (one FEN per line, see test_fen_positions.txt).
+//
+// For every position, and every position one legal move after it:
+//   - FEN round trip: board_to_fen(board_from_fen(fen)) gives the same FEN
+//     back (for the file's positions, exactly the line in the file)
+//   - the incrementally updated Zobrist hash and material key of make_move
+//     match the ones computed from scratch for the same position
+//   - is_legal agrees with generate_legal_moves on every from/to pair (and
+//     every promotion piece), so the TT move is searched exactly when the
+//     generator would have produced it
+//
+// Usage: chess-king-position-checks <fen file>
+// Prints one line per position and exits with status 1 if any check fails.
+
+#include "board.h"
+#include "fen.h"
+#include "../zobrist_h.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool same_move(const move& a, const move& b) {
+    return a.from_row == b.from_row && a.from_col == b.from_col &&
+           a.to_row == b.to_row && a.to_col == b.to_col && a.promotion == b.promotion;
+}
+
+bool in_list(const std::vector<move>& moves, const move& m) {
+    for (const move& candidate : moves) {
+        if (same_move(candidate, m)) return true;
+    }
+    return false;
+}
+
+// Reports the first problem with BOARD as WHAT (empty if none)
+std::string check_board(const Board& board) {
+    const std::string fen = board_to_fen(board);
+    Board parsed;
+    if (!board_from_fen(fen, parsed)) return "own FEN does not parse: " + fen;
+    if (board_to_fen(parsed) != fen) return "FEN round trip changed " + fen + " to " + board_to_fen(parsed);
+    if (parsed.zobrist_hash != board.zobrist_hash || compute_zobrist(board) != board.zobrist_hash) {
+        return "Zobrist hash differs from the recomputed one in " + fen;
+    }
+    if (compute_material_key(board) != board.material_key) return "material key is stale in " + fen;
+
+    const std::vector<move> legal = generate_legal_moves(board);
+    for (int from = 0; from < 64; ++from) {
+        for (int to = 0; to < 64; ++to) {
+            for (int promo = NONE; promo <= KNIGHT; ++promo) {
+                const move m(from / 8, from % 8, to / 8, to % 8, static_cast<promotion_piece_type>(promo));
+                if (is_legal(board, m) != in_list(legal, m)) {
+                    return "is_legal disagrees with the generator on " + move_to_uci(m) + " in " + fen;
+                }
+            }
+        }
+    }
+    return "";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <fen file>\n";
+        return 1;
+    }
+    std::ifstream in(argv[1]);
+    if (!in) {
+        std::cerr << "Cannot open " << argv[1] << '\n';
+        return 1;
+    }
+
+    init_zobrist();
+    int failures = 0;
+    int positions = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.pop_back();
+        if (line.empty()) continue;
+        ++positions;
+
+        Board board;
+        std::string problem;
+        if (!board_from_fen(line, board)) {
+            problem = "does not parse";
+        } else if (board_to_fen(board) != line) {
+            problem = "round trip gives " + board_to_fen(board);
+        } else {
+            problem = check_board(board);
+            for (const move& m : generate_legal_moves(board)) {
+                if (!problem.empty()) break;
+                Board child = board;
+                make_move(child, m);
+                problem = check_board(child);
+            }
+        }
+
+        std::cout << (problem.empty() ? "ok   " : "FAIL ") << line
+                  << (problem.empty() ? "" : "\n     " + problem) << '\n';
+        if (!problem.empty()) ++failures;
+    }
+
+    std::cout << positions - failures << " of " << positions << " positions passed\n";
+    return failures == 0 && positions > 0 ? 0 : 1;
+}
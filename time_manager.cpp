@@ -0,0 +1,68 @@
+#include "time_manager.h"
+#include <algorithm>
+
+// ============================================================================
+// TIME MANAGER - Decides how long to think about each move
+// ============================================================================
+// With a clock we aim to spread the remaining time over the moves still to
+// play (moves_to_go, or a fixed horizon in sudden death), plus most of the
+// increment. That target is the soft limit. The hard limit lets a single
+// difficult move use several times the target, but never more than a fraction
+// of what is left, minus a safety margin for process start-up and file I/O.
+//
+// With a fixed time per move the hard limit is that time and the soft limit
+// is half of it, so easy moves (stable best move, forced replies) return early.
+// An exact move time (fixed_move_time, UCI "movetime") has no soft limit.
+// ============================================================================
+
+namespace {
+constexpr int MOVE_OVERHEAD_MS = 50;       // Kept back for start-up, I/O and clock lag
+constexpr int SUDDEN_DEATH_HORIZON = 30;   // Moves we assume are left without moves_to_go
+constexpr int MAX_MOVES_TO_GO = 50;
+constexpr int HARD_LIMIT_FACTOR = 4;       // Hard limit = up to 4x the soft target...
+constexpr int MAX_CLOCK_FRACTION = 3;      // ...but at most 1/3 of the remaining clock
+constexpr int MIN_BUDGET_MS = 10;
+
+// Soft-limit scale by the number of consecutive iterations that kept the best move
+constexpr double STABILITY_SCALE[] = {1.40, 1.10, 0.90, 0.75, 0.60};
+constexpr int MAX_STABILITY = 4;
+constexpr double FAIL_LOW_SCALE = 1.50;
+} // anonymous namespace
+
+TimeBudget allocate_time(const TimeControl& tc) {
+    TimeBudget budget;
+    budget.max_nodes = tc.max_nodes;
+
+    if (tc.clock_ms <= 0) {
+        // Fixed time per move
+        if (tc.move_time_ms <= 0) return budget;  // No limit at all
+        budget.hard_ms = std::max(MIN_BUDGET_MS, tc.move_time_ms);
+        if (!tc.fixed_move_time) budget.soft_ms = std::max(MIN_BUDGET_MS, budget.hard_ms / 2);
+        return budget;
+    }
+
+    const int available = std::max(MIN_BUDGET_MS, tc.clock_ms - MOVE_OVERHEAD_MS);
+    const int moves_left = tc.moves_to_go > 0 ? std::min(tc.moves_to_go, MAX_MOVES_TO_GO)
+                                              : SUDDEN_DEATH_HORIZON;
+
+    int soft = available / moves_left + tc.increment_ms * 3 / 4;
+    int hard = std::min(soft * HARD_LIMIT_FACTOR, available / MAX_CLOCK_FRACTION + tc.increment_ms);
+    // Last move before the time control: everything left may go into it
+    if (tc.moves_to_go == 1) hard = available;
+
+    hard = std::clamp(hard, MIN_BUDGET_MS, available);
+    budget.soft_ms = std::clamp(soft, MIN_BUDGET_MS, hard);
+    budget.hard_ms = hard;
+    // A fixed move time, if also given, caps the clock-based budget
+    if (tc.move_time_ms > 0) {
+        budget.hard_ms = std::min(budget.hard_ms, tc.move_time_ms);
+        budget.soft_ms = std::min(budget.soft_ms, budget.hard_ms);
+    }
+    return budget;
+}
+
+double time_scale(int best_move_stability, bool failed_low) {
+    double scale = STABILITY_SCALE[std::clamp(best_move_stability, 0, MAX_STABILITY)];
+    if (failed_low) scale *= FAIL_LOW_SCALE;
+    return scale;
+}
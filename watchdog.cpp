@@ -0,0 +1,86 @@
+#include "watchdog.h"
+
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+// ============================================================================
+// MOVE DEADLINE WATCHDOG
+// ============================================================================
+// The search checks the clock itself, but it can only stop once it unwinds,
+// and anything between the search and the final write (or a bug) could still
+// make us miss the deadline - which forfeits the game. The watchdog doesn't
+// depend on any of that: at the deadline it writes the best move from the
+// last completed iteration and exits the process.
+//
+// All state is guarded by one mutex, so the watchdog either fires before
+// stop_move_watchdog() takes the lock, or never.
+// ============================================================================
+
+namespace {
+std::mutex g_watchdog_mutex;
+std::condition_variable g_watchdog_cv;
+std::thread g_watchdog_thread;
+
+std::string g_move_path;
+move g_published_move;
+bool g_anytime = false;
+bool g_stopped = false;
+bool g_fired = false;  // Deadline passed; the process is exiting
+
+void watchdog_main(std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(g_watchdog_mutex);
+    if (g_watchdog_cv.wait_until(lock, deadline, [] { return g_stopped; })) {
+        return;  // Engine finished in time
+    }
+
+    g_fired = true;
+    std::cerr << "Watchdog: deadline reached, writing " << move_to_uci(g_published_move) << "\n";
+    write_move_to_file(g_published_move, g_move_path);
+    std::cerr.flush();
+    // The search may still be running; don't wait for it or run destructors
+    std::_Exit(0);
+}
+} // anonymous namespace
+
+void start_move_watchdog(const std::string& move_path,
+                         std::chrono::steady_clock::time_point deadline,
+                         const move& fallback, bool anytime) {
+    {
+        std::lock_guard<std::mutex> lock(g_watchdog_mutex);
+        g_move_path = move_path;
+        g_published_move = fallback;
+        g_anytime = anytime;
+        g_stopped = false;
+        g_fired = false;
+    }
+    if (anytime) {
+        write_move_to_file(fallback, move_path);
+    }
+    g_watchdog_thread = std::thread(watchdog_main, deadline);
+}
+
+void publish_best_move(const move& m) {
+    std::lock_guard<std::mutex> lock(g_watchdog_mutex);
+    if (g_stopped || g_fired) return;
+    g_published_move = m;
+    // Anytime mode: the file always holds the deepest completed result
+    if (g_anytime) {
+        write_move_to_file(m, g_move_path);
+    }
+}
+
+// If the watchdog has already fired it holds the mutex until the process
+// exits, so this never returns into a second write
+void stop_move_watchdog() {
+    {
+        std::lock_guard<std::mutex> lock(g_watchdog_mutex);
+        g_stopped = true;
+    }
+    g_watchdog_cv.notify_all();
+    if (g_watchdog_thread.joinable()) {
+        g_watchdog_thread.join();
+    }
+}